@@ -0,0 +1,112 @@
+#include "Admission.hpp"
+
+#include <algorithm>
+
+#include "Instance.hpp"
+
+// ms, kept aside for generating and sending the moves
+const double SAFETY_MARGIN = 75;
+// the model is not perfect, we leave some room
+const double PREDICTION_SLACK = 1.25;
+// we always navigate at least these ships, NavigateShips has its own timeout checks
+const int MIN_ADMITTED = 20;
+// how much work an event horizon edge adds relative to a request (conflicts, frozen ships updates)
+const double EDGE_WORK = 0.25;
+// how much the last turn counts
+const double LEARNING_RATE = 0.3;
+
+AdmissionControl::AdmissionControl(Log& logger) : logger(logger)
+{
+	// conservative priors, the first turns have very few ships anyway
+	// (filling the map is mostly proportional to the cells)
+	for (int l = 0; l < MAP_DEFINITION_LEVELS; l++)
+		fixed[l] = 20.0 / (1 << (2 * l));
+	last_fixed = 0;
+	cost_per_work = 3;
+}
+
+int AdmissionControl::Admit(const ArenaVector<NavigationRequest*>& navigationRequests, double budget_ms)
+{
+	const double horizon2 = EVENT_HORIZON_RADIUS * EVENT_HORIZON_RADIUS;
+	budget_ms -= SAFETY_MARGIN;
+
+	// edges[i] = edges between the first i requests, computed as far as needed
+	std::vector<int> edges(1, 0);
+	auto edgesUpTo = [&](int count) {
+		while (edges.size() <= count) {
+			const int i = edges.size() - 1;
+			const Vector2& location = navigationRequests[i]->ship->location;
+
+			int new_edges = 0;
+			for (int j = 0; j < i; j++) {
+				if (location.DistanceTo2(navigationRequests[j]->ship->location) < horizon2)
+					new_edges++;
+			}
+			edges.push_back(edges.back() + new_edges);
+		}
+		return edges[count];
+	};
+
+	auto admit = [&](int l) {
+		int admitted = 0;
+		while (admitted < navigationRequests.size()) {
+			if (admitted >= MIN_ADMITTED && Predict(l, admitted + 1, edgesUpTo(admitted + 1)) * PREDICTION_SLACK > budget_ms)
+				break;
+			admitted++;
+		}
+		return admitted;
+	};
+
+	// the finest map that lets us navigate every request, or the one that navigates the most
+	int admitted = -1;
+	for (int l = 0; l < MAP_DEFINITION_LEVELS; l++) {
+		int admitted_level = admit(l);
+		if (admitted_level > admitted) {
+			admitted = admitted_level;
+			level = l;
+		}
+		if (admitted == navigationRequests.size())
+			break;
+	}
+
+	definition = MAP_DEFINITIONS[level];
+	admitted_edges = edgesUpTo(admitted);
+
+	logger.log() << "Admitted " << admitted << " of " << navigationRequests.size() << " navigation requests"
+			   << " (predicted: " << Predict(level, admitted, admitted_edges) << "ms budget: " << budget_ms << "ms"
+			   << " model: " << fixed[level] << "ms + " << cost_per_work << "ms/work, definition: " << definition << ")" << std::endl;
+
+	return admitted;
+}
+
+void AdmissionControl::ObserveFixed(double elapsed_ms)
+{
+	last_fixed = elapsed_ms;
+	fixed[level] += (elapsed_ms - fixed[level]) * LEARNING_RATE;
+}
+
+void AdmissionControl::Observe(int requests, int edges, double elapsed_ms, bool timed_out)
+{
+	if (requests == 0)
+		return;
+
+	const double work = requests + EDGE_WORK * edges;
+	const double observed = std::max(0.0, elapsed_ms - last_fixed) / work;
+
+	// if we timed out the real cost is higher than what we measured,
+	// we can only learn something if we were too optimistic
+	if (timed_out && observed < cost_per_work)
+		return;
+
+	cost_per_work += (observed - cost_per_work) * LEARNING_RATE;
+}
+
+double AdmissionControl::Predict(int requests, int edges) const
+{
+	return Predict(level, requests, edges);
+}
+
+double AdmissionControl::Predict(int level, int requests, int edges) const
+{
+	return fixed[level] + cost_per_work * (requests + EDGE_WORK * edges);
+}
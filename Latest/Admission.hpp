@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "Navigation.hpp"
+#include "Map.hpp"
+#include "Log.hpp"
+
+/*
+	Decides how many navigation requests we can afford to navigate this turn.
+	The navigation time is modeled as
+		time = fixed + cost_per_work * (requests + EDGE_WORK * event_horizon_edges)
+	fixed is the time spent filling the map (it depends on the whole map, not on the requests)
+	and both fixed and cost_per_work are learned online from the time that NavigateShips
+	actually took in the previous turns, so the model adapts to the map, the players and the machine
+
+	fixed is learned for every map definition: if the fine map doesn't leave time to navigate
+	every request a coarser one is used (see Map::definition)
+*/
+class AdmissionControl {
+public:
+	AdmissionControl(Log& logger);
+
+	// navigationRequests must be sorted by importance, returns how many of them (from the front) should be navigated
+	// and picks the definition of the map
+	int Admit(const ArenaVector<NavigationRequest*>& navigationRequests, double budget_ms);
+	// feedback of the last navigation
+	void ObserveFixed(double elapsed_ms);
+	void Observe(int requests, int edges, double elapsed_ms, bool timed_out);
+
+	double Predict(int requests, int edges) const;
+
+	// edges between the requests admitted in the last call to Admit
+	int admitted_edges = 0;
+	// the map definition picked in the last call to Admit
+	int definition = MAP_DEFINITION;
+
+private:
+	double Predict(int level, int requests, int edges) const;
+
+	Log& logger;
+
+	int level = 0; // of definition in MAP_DEFINITIONS
+	double fixed[MAP_DEFINITION_LEVELS]; // ms
+	double last_fixed; // ms
+	double cost_per_work; // ms
+};
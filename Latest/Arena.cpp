@@ -0,0 +1,59 @@
+#include "Arena.hpp"
+
+#include <algorithm>
+
+const size_t BLOCK_SIZE = 1 << 20; // 1MB
+
+Arena::Arena()
+	: current_block(0), offset(0)
+{
+}
+
+Arena::~Arena()
+{
+	for (Block& block : blocks)
+		delete[] block.data;
+}
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+	while (current_block < blocks.size()) {
+		Block& block = blocks[current_block];
+
+		size_t aligned = (reinterpret_cast<size_t>(block.data) + offset + alignment - 1) & ~(alignment - 1);
+		size_t start = aligned - reinterpret_cast<size_t>(block.data);
+
+		if (start + size <= block.size) {
+			offset = start + size;
+			return block.data + start;
+		}
+
+		// doesn't fit, try the next block
+		current_block++;
+		offset = 0;
+	}
+
+	// we need more memory
+	Block block;
+	block.size = std::max(BLOCK_SIZE, size + alignment);
+	block.data = new char[block.size];
+	blocks.push_back(block);
+
+	current_block = blocks.size() - 1;
+	offset = 0;
+	return Allocate(size, alignment);
+}
+
+void Arena::Reset()
+{
+	current_block = 0;
+	offset = 0;
+}
+
+size_t Arena::Used() const
+{
+	size_t used = offset;
+	for (size_t i = 0; i < current_block && i < blocks.size(); i++)
+		used += blocks[i].size;
+	return used;
+}
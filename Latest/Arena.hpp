@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <set>
+#include <cstddef>
+#include <utility>
+
+/*
+	Bump allocator for the objects that only live during a turn.
+	Reset() releases everything at once but keeps the memory for the next turn,
+	so once the blocks have grown enough a turn doesn't touch the global allocator.
+	Destructors are never called and it's NOT thread safe: allocate before spawning workers.
+*/
+class Arena {
+public:
+	Arena();
+	~Arena();
+
+	void* Allocate(size_t size, size_t alignment);
+	void Reset();
+
+	template<typename T, typename... Args>
+	T* New(Args&&... args) {
+		return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	// memory used since the last reset (including the unused end of the full blocks)
+	size_t Used() const;
+
+private:
+	struct Block {
+		char* data;
+		size_t size;
+	};
+
+	std::vector<Block> blocks;
+	size_t current_block;
+	size_t offset;
+};
+
+/* Allocator for the STL containers that live during a turn */
+template<typename T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+
+	ArenaAllocator(Arena* arena) : arena(arena) { }
+
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) { }
+
+	T* allocate(size_t n) {
+		return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, size_t) {
+		// released in Arena::Reset
+	}
+
+	template<typename U>
+	bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+
+	template<typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+	Arena* arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+template<typename T>
+using ArenaSet = std::set<T, std::less<T>, ArenaAllocator<T>>;
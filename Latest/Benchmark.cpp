@@ -0,0 +1,285 @@
+#include "Instance.hpp"
+#include "Navigation.hpp"
+
+#include <map>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+/////////////////////////////////////////////
+// Times every phase of a turn over synthetic game states
+// with a growing amount of ships, no engine or opponents needed:
+//   Benchmark.exe [width height planets repetitions]
+// For every player count and layout (spread or clustered)
+// it prints a row per ship count (our ships, every enemy has the same)
+// and the fitted exponent of each phase (1 = linear, 2 = quadratic)
+/////////////////////////////////////////////
+
+const int SHIP_COUNTS[] = { 10, 25, 50, 100, 250, 500, 1000 };
+const int PLAYER_COUNTS[] = { 2, 4 };
+
+// column, stopwatch (see Stopwatch::PhaseName)
+const std::pair<const char*, const char*> PHASES[] = {
+	{ "GenerateTasks", "Generate tasks" },
+	{ "AssignTasks", "Assign tasks" },
+	{ "ComputeAction", "Compute N actions" },
+	{ "EventHorizons", "Filling event horizons" },
+	{ "UpdateMaxThrusts", "Calculating max thrusts" },
+	{ "FillMap", "Clear and fill the map" },
+	{ "CalculateScores", "Calculating scores Nst time" },
+	{ "Skirmish", "Skirmish search (N skirmishes, N threads)" },
+	{ "PickOptions", "Picking options (N components, N threads)" },
+	{ "NavigateShips", "Navigate N ships" },
+};
+const int PHASES_COUNT = sizeof(PHASES) / sizeof(PHASES[0]);
+
+// times below this are noise for the fit
+const double MIN_FIT_TIME = 0.05; // ms
+
+struct SyntheticPlanet {
+	Vector2 location;
+	double radius;
+	int docking_spots;
+	int owner; // -1 if not owned
+};
+
+static bool IsFree(const std::vector<SyntheticPlanet>& planets, const Vector2& location, double margin) {
+	for (const SyntheticPlanet& planet : planets) {
+		if (planet.location.DistanceTo(location) < planet.radius + margin)
+			return false;
+	}
+	return true;
+}
+
+static std::vector<SyntheticPlanet> GeneratePlanets(int width, int height, int count, std::mt19937& rng) {
+	std::vector<SyntheticPlanet> planets;
+	std::uniform_real_distribution<double> radiusDist(3, 10);
+
+	for (int i = 0; i < count; i++) {
+		for (int attempt = 0; attempt < 100; attempt++) {
+			double radius = radiusDist(rng);
+			Vector2 location = {
+				std::uniform_real_distribution<double>(radius + 5, width - radius - 5)(rng),
+				std::uniform_real_distribution<double>(radius + 5, height - radius - 5)(rng)
+			};
+
+			if (IsFree(planets, location, radius + 8)) {
+				planets.push_back({ location, radius, (int)(radius / 2) + 1, -1 });
+				break;
+			}
+		}
+	}
+
+	return planets;
+}
+
+// a line in the same format that the engine sends every turn
+// half of the planets are owned (round robin) and a tenth of the ships of every player are docked to them
+static std::string GenerateFrame(int width, int height, int players, std::vector<SyntheticPlanet> planets, int shipsPerPlayer, bool clustered, std::mt19937& rng) {
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(4);
+
+	for (int i = 0; i < planets.size(); i++)
+		planets[i].owner = i < planets.size() / 2 ? i % players : -1;
+
+	std::vector<std::vector<EntityId>> docked(planets.size());
+	EntityId entity_id = 0;
+
+	oss << players;
+	for (int player = 0; player < players; player++) {
+		oss << " " << player << " " << shipsPerPlayer;
+
+		Vector2 center = {
+			std::uniform_real_distribution<double>(20, width - 20)(rng),
+			std::uniform_real_distribution<double>(20, height - 20)(rng)
+		};
+		std::normal_distribution<double> clusterDist(0, 20);
+
+		int toDock = shipsPerPlayer / 10;
+
+		for (int i = 0; i < shipsPerPlayer; i++) {
+			EntityId docked_planet = 0;
+			int docking_status = 0;
+			Vector2 location;
+
+			// dock to the first planet of ours with a free spot
+			if (toDock > 0) {
+				for (int j = 0; j < planets.size(); j++) {
+					if (planets[j].owner == player && docked[j].size() < planets[j].docking_spots) {
+						double angle = docked[j].size() * 2 * M_PI / planets[j].docking_spots;
+						location = planets[j].location + Vector2{ cos(angle), sin(angle) } * (planets[j].radius + 1);
+						docked[j].push_back(entity_id);
+						docked_planet = j;
+						docking_status = 2;
+						toDock--;
+						break;
+					}
+				}
+			}
+
+			if (docking_status == 0) {
+				do {
+					if (clustered)
+						location = center + Vector2{ clusterDist(rng), clusterDist(rng) };
+					else
+						location = {
+							std::uniform_real_distribution<double>(0, width)(rng),
+							std::uniform_real_distribution<double>(0, height)(rng)
+						};
+					location.x = std::min(std::max(location.x, 2.0), width - 2.0);
+					location.y = std::min(std::max(location.y, 2.0), height - 2.0);
+				} while (!IsFree(planets, location, 2));
+			}
+
+			// id x y health vel_x vel_y docking_status docked_planet docking_progress weapon_cooldown
+			oss << " " << entity_id++ << " " << location.x << " " << location.y << " 255 0 0 "
+				<< docking_status << " " << docked_planet << " 0 0";
+		}
+	}
+
+	oss << " " << planets.size();
+	for (int j = 0; j < planets.size(); j++) {
+		const SyntheticPlanet& planet = planets[j];
+		// id x y health radius docking_spots current_production remaining_production owned owner docked_ships...
+		oss << " " << j << " " << planet.location.x << " " << planet.location.y << " 1000 " << planet.radius << " "
+			<< planet.docking_spots << " 0 1000 " << (planet.owner != -1 ? 1 : 0) << " " << std::max(planet.owner, 0)
+			<< " " << docked[j].size();
+		for (EntityId ship_id : docked[j])
+			oss << " " << ship_id;
+	}
+
+	return oss.str();
+}
+
+// runs the phases of Instance::Frame separately, returns stopwatch -> ms
+static std::map<std::string, double> RunTurn(Instance* instance, const std::string& frame, bool& timedOut) {
+	instance->arena.Reset();
+	instance->turn = 100; // mid game
+	instance->BeginTurn(frame);
+
+	instance->GenerateTasks();
+	instance->AssignTasks();
+
+	ArenaVector<NavigationRequest*> navigationRequests(&instance->arena);
+	{
+		Stopwatch s(instance, "Compute " + std::to_string(instance->myShips.size()) + " actions");
+		for (Ship* ship : instance->myShips) {
+			auto action = ship->ComputeAction();
+			if (action.second.second)
+				navigationRequests.push_back(action.second.first);
+		}
+	}
+
+	// no admission control, we want to know how the full navigation scales
+	NavigationRequestSet navigationRequestsSet(&instance->arena);
+	for (NavigationRequest* navReq : navigationRequests) {
+		navReq->near_combat = instance->CountNearbyShips(navReq->ship->location, navReq->ship->radius, COMBAT_RANGE, false) > 0;
+		navReq->ship->frozen = false;
+		navigationRequestsSet.insert(navReq);
+	}
+
+	instance->turn_start = std::chrono::high_resolution_clock::now();
+	Navigation::NavigateShips(instance, navigationRequestsSet);
+	if (instance->CurrentTurnTime() > MAX_TIME)
+		timedOut = true;
+
+	std::map<std::string, double> timings;
+	for (auto& timing : instance->timings)
+		timings[Stopwatch::PhaseName(timing.first)] += timing.second;
+	instance->FlushTimings();
+
+	return timings;
+}
+
+// least squares slope of log(time) over log(ships)
+static double FitExponent(const std::vector<std::pair<double, double>>& points) {
+	double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+	for (auto& point : points) {
+		if (point.second < MIN_FIT_TIME) continue;
+		double x = log(point.first), y = log(point.second);
+		n++; sx += x; sy += y; sxx += x * x; sxy += x * y;
+	}
+	if (n < 2)
+		return NAN;
+	return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+int main(int argc, char** argv) {
+	int width = argc > 2 ? std::atoi(argv[1]) : 384;
+	int height = argc > 2 ? std::atoi(argv[2]) : 256;
+	int planetCount = argc > 3 ? std::atoi(argv[3]) : 24;
+	int repetitions = argc > 4 ? std::max(1, std::atoi(argv[4])) : 3;
+
+	std::mt19937 rng(42);
+	std::vector<SyntheticPlanet> planets = GeneratePlanets(width, height, planetCount, rng);
+
+	// the same initialization as a real game
+	std::istringstream init("0\n" + std::to_string(width) + " " + std::to_string(height) + "\n" + GenerateFrame(width, height, 2, planets, 3, false, rng) + "\n");
+	std::ostringstream discard; // the bot name
+
+	Instance* instance = new Instance();
+	instance->in_stream = &init;
+	instance->out_stream = &discard;
+	instance->Initialize("benchmark");
+	instance->FlushTimings();
+	instance->rush_phase = false;
+
+	std::cout << "Map: " << width << "x" << height << " planets: " << planets.size() << " repetitions: " << repetitions
+			  << " (best time of every phase, ms)" << std::endl;
+
+	for (int players : PLAYER_COUNTS) {
+		for (int clustered = 0; clustered < 2; clustered++) {
+			std::cout << std::endl << players << " players, " << (clustered ? "clustered" : "spread") << std::endl;
+			std::cout << std::setw(6) << "ships";
+			for (auto& phase : PHASES)
+				std::cout << std::setw(17) << phase.first;
+			std::cout << std::endl;
+
+			std::vector<std::vector<std::pair<double, double>>> curves(PHASES_COUNT);
+
+			for (int ships : SHIP_COUNTS) {
+				std::string frame = GenerateFrame(width, height, players, planets, ships, clustered == 1, rng);
+
+				std::vector<double> best(PHASES_COUNT, INF);
+				bool timedOut = false;
+
+				for (int r = 0; r < repetitions; r++) {
+					std::map<std::string, double> timings = RunTurn(instance, frame, timedOut);
+					for (int i = 0; i < PHASES_COUNT; i++) {
+						auto it = timings.find(PHASES[i].second);
+						if (it != timings.end())
+							best[i] = std::min(best[i], (*it).second);
+					}
+				}
+
+				std::cout << std::setw(6) << ships << std::fixed << std::setprecision(2);
+				for (int i = 0; i < PHASES_COUNT; i++) {
+					if (best[i] == INF)
+						std::cout << std::setw(17) << "-";
+					else {
+						std::cout << std::setw(17) << best[i];
+						curves[i].push_back(std::make_pair((double)ships, best[i]));
+					}
+				}
+				if (timedOut)
+					std::cout << "  (timed out)";
+				std::cout << std::endl;
+			}
+
+			std::cout << std::setw(6) << "exp";
+			for (int i = 0; i < PHASES_COUNT; i++) {
+				double exponent = FitExponent(curves[i]);
+				if (std::isnan(exponent))
+					std::cout << std::setw(17) << "-";
+				else
+					std::cout << std::setw(17) << exponent;
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	delete instance;
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include "Combat.hpp"
+
+#include "Instance.hpp"
+
+using namespace hlt::constants;
+
+// the ships shoot the enemies that get this close during the turn (center to center)
+const float COMBAT_ATTACK_RANGE = (float)(WEAPON_RADIUS + SHIP_RADIUS * 2);
+const float COMBAT_COLLISION_RANGE = (float)(SHIP_RADIUS * 2);
+
+// how much an alive ship is worth in Evaluate, on top of its health
+const double SHIP_VALUE = MAX_SHIP_HEALTH;
+
+Combat::Combat()
+{
+	Clear(0, 0);
+}
+
+void Combat::Clear(int map_width, int map_height)
+{
+	count = 0;
+	this->map_width = (float)map_width;
+	this->map_height = (float)map_height;
+}
+
+int Combat::AddShip(EntityId id, PlayerId owner, const Vector2& location, int health, bool docked, bool can_shoot)
+{
+	if (count >= COMBAT_MAX_SHIPS)
+		return -1;
+
+	int i = count++;
+	ids[i] = id;
+	this->owner[i] = owner;
+	x[i] = (float)location.x;
+	y[i] = (float)location.y;
+	vx[i] = vy[i] = 0;
+	this->health[i] = health;
+	this->docked[i] = docked;
+	this->can_shoot[i] = can_shoot;
+	return i;
+}
+
+void Combat::AddShipsAround(Instance* instance, const Vector2& center, double radius)
+{
+	// the closest ones, kept sorted by insertion (no allocations)
+	Ship* closest[COMBAT_MAX_SHIPS];
+	double distances[COMBAT_MAX_SHIPS];
+	int found = 0;
+	const int capacity = COMBAT_MAX_SHIPS - count;
+
+	for (auto& kv : instance->ships) {
+		Ship* ship = kv.second;
+		if (!ship->alive) continue;
+
+		double distance = center.DistanceTo(ship->location);
+		if (distance > radius) continue;
+		if (found == capacity && (capacity == 0 || distance >= distances[found - 1])) continue;
+
+		int i = found < capacity ? found++ : found - 1;
+		while (i > 0 && (distances[i - 1] > distance || (distances[i - 1] == distance && closest[i - 1]->entity_id > ship->entity_id))) {
+			closest[i] = closest[i - 1];
+			distances[i] = distances[i - 1];
+			i--;
+		}
+		closest[i] = ship;
+		distances[i] = distance;
+	}
+
+	for (int i = 0; i < found; i++) {
+		Ship* ship = closest[i];
+		bool undocked = ship->docking_status == ShipDockingStatus::Undocked;
+		AddShip(ship->entity_id, ship->owner_id, ship->location, ship->health, !undocked, undocked && ship->weapon_cooldown == 0);
+	}
+}
+
+int Combat::FindShip(EntityId id) const
+{
+	for (int i = 0; i < count; i++) {
+		if (ids[i] == id)
+			return i;
+	}
+	return -1;
+}
+
+void Combat::SetVelocity(int index, const Vector2& velocity)
+{
+	if (docked[index]) return;
+	vx[index] = (float)velocity.x;
+	vy[index] = (float)velocity.y;
+}
+
+void Combat::Step()
+{
+	const float attack2 = COMBAT_ATTACK_RANGE * COMBAT_ATTACK_RANGE;
+	const float collision2 = COMBAT_COLLISION_RANGE * COMBAT_COLLISION_RANGE;
+
+	int alive[COMBAT_MAX_SHIPS];
+	int damage[COMBAT_MAX_SHIPS];
+	int collided[COMBAT_MAX_SHIPS];
+	for (int j = 0; j < count; j++) {
+		alive[j] = health[j] > 0;
+		damage[j] = 0;
+		collided[j] = 0;
+	}
+
+	int inRange[COMBAT_MAX_SHIPS];
+	for (int i = 0; i < count; i++) {
+		if (!alive[i]) continue;
+
+		int targets = 0;
+		// branchless so it vectorizes: the closest approach of i and j during the turn
+		for (int j = 0; j < count; j++) {
+			const float dx = x[j] - x[i], dy = y[j] - y[i];
+			const float dvx = vx[j] - vx[i], dvy = vy[j] - vy[i];
+			const float vv = dvx * dvx + dvy * dvy;
+			float t = vv > 0 ? -(dx * dvx + dy * dvy) / (vv > 0 ? vv : 1) : 0;
+			t = t < 0 ? 0 : (t > 1 ? 1 : t);
+			const float cx = dx + dvx * t, cy = dy + dvy * t;
+			const float d2 = cx * cx + cy * cy;
+
+			inRange[j] = alive[j] & (owner[j] != owner[i]) & (d2 <= attack2);
+			collided[i] |= alive[j] & (j != i) & (d2 < collision2);
+			targets += inRange[j];
+		}
+
+		if (!can_shoot[i] || targets == 0) continue;
+
+		// the damage is split evenly (integer division, like the engine)
+		const int share = WEAPON_DAMAGE / targets;
+		for (int j = 0; j < count; j++)
+			damage[j] += inRange[j] * share;
+	}
+
+	for (int j = 0; j < count; j++) {
+		x[j] += vx[j];
+		y[j] += vy[j];
+		vx[j] = vy[j] = 0;
+
+		const bool outside = x[j] < 0 || y[j] < 0 || x[j] > map_width || y[j] > map_height;
+		health[j] = collided[j] || outside ? 0 : health[j] - damage[j];
+		if (health[j] < 0)
+			health[j] = 0;
+	}
+}
+
+double Combat::Evaluate(PlayerId player) const
+{
+	double score = 0;
+	for (int i = 0; i < count; i++) {
+		if (health[i] <= 0) continue;
+		double value = health[i] + SHIP_VALUE;
+		score += owner[i] == player ? value : -value;
+	}
+	return score;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "constants.hpp"
+#include "Types.hpp"
+#include "Vector2.hpp"
+
+class Instance;
+
+// ships in a local combat, the rest are ignored
+const int COMBAT_MAX_SHIPS = 32;
+
+/*
+	Compact simulation of one turn over a local cluster of ships, to evaluate joint moves.
+	The state is fixed-size (copy it to try another set of moves) and nothing is allocated.
+
+	A turn is:
+	 - every ship moves in a straight line with its velocity (docked ships don't move)
+	 - every ship that can shoot splits WEAPON_DAMAGE between all the enemies that get
+	   in range at some point of the turn (closest approach)
+	 - ships that get closer than two radii or leave the map die
+	 - ships without health die
+
+	Compared to the engine (see Simulator.cpp) the attacks are not solved in time order
+	and the planets are ignored (the navigation options already avoid them).
+	The arrays are SoA so the pairwise loops can be vectorized.
+*/
+class Combat {
+public:
+	Combat();
+
+	void Clear(int map_width, int map_height);
+	// returns the index of the ship or -1 if the combat is full
+	int AddShip(EntityId id, PlayerId owner, const Vector2& location, int health, bool docked, bool can_shoot);
+	// adds the ships closest to center (alive ships within radius, up to COMBAT_MAX_SHIPS)
+	void AddShipsAround(Instance* instance, const Vector2& center, double radius);
+	int FindShip(EntityId id) const;
+
+	void SetVelocity(int index, const Vector2& velocity);
+	void Step();
+
+	// sum of (health + SHIP_VALUE) of the alive ships of player minus the ones of the enemies
+	double Evaluate(PlayerId player) const;
+
+	bool IsAlive(int index) const { return health[index] > 0; }
+
+	int count;
+	float map_width, map_height;
+
+	// by index
+	float x[COMBAT_MAX_SHIPS], y[COMBAT_MAX_SHIPS];
+	float vx[COMBAT_MAX_SHIPS], vy[COMBAT_MAX_SHIPS];
+	int health[COMBAT_MAX_SHIPS];
+	PlayerId owner[COMBAT_MAX_SHIPS];
+	EntityId ids[COMBAT_MAX_SHIPS];
+	unsigned char docked[COMBAT_MAX_SHIPS];
+	unsigned char can_shoot[COMBAT_MAX_SHIPS]; // undocked and the weapon is ready
+};
@@ -0,0 +1,152 @@
+#include "Density.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include "Ship.hpp"
+
+// the cells closer than this to the border are checked ship by ship
+const double DENSITY_EPSILON = 1e-6;
+
+DensityGrid::DensityGrid() : columns(0), rows(0), dirty(false)
+{
+}
+
+void DensityGrid::Clear(int map_width, int map_height)
+{
+	columns = std::max(1, (int)std::ceil(map_width / DENSITY_CELL_SIZE));
+	rows = std::max(1, (int)std::ceil(map_height / DENSITY_CELL_SIZE));
+
+	buckets.resize(columns * rows);
+	for (auto& bucket : buckets)
+		bucket.clear();
+	table.assign((columns + 1) * (rows + 1), 0);
+	dirty = false;
+}
+
+int DensityGrid::CellX(double x) const
+{
+	return std::max(0, std::min(columns - 1, (int)std::floor(x / DENSITY_CELL_SIZE)));
+}
+
+int DensityGrid::CellY(double y) const
+{
+	return std::max(0, std::min(rows - 1, (int)std::floor(y / DENSITY_CELL_SIZE)));
+}
+
+void DensityGrid::Add(Ship* ship)
+{
+	auto& bucket = buckets[CellY(ship->location.y) * columns + CellX(ship->location.x)];
+	if (std::find(bucket.begin(), bucket.end(), ship) != bucket.end())
+		return;
+	bucket.push_back(ship);
+	dirty = true;
+}
+
+void DensityGrid::Remove(Ship* ship)
+{
+	auto& bucket = buckets[CellY(ship->location.y) * columns + CellX(ship->location.x)];
+	auto it = std::find(bucket.begin(), bucket.end(), ship);
+	if (it == bucket.end())
+		return;
+	bucket.erase(it);
+	dirty = true;
+}
+
+bool DensityGrid::Contains(Ship* ship) const
+{
+	const auto& bucket = buckets[CellY(ship->location.y) * columns + CellX(ship->location.x)];
+	return std::find(bucket.begin(), bucket.end(), ship) != bucket.end();
+}
+
+void DensityGrid::BuildTable()
+{
+	const int stride = columns + 1;
+	for (int y = 0; y < rows; y++) {
+		int row = 0;
+		for (int x = 0; x < columns; x++) {
+			row += (int)buckets[y * columns + x].size();
+			table[(y + 1) * stride + x + 1] = table[y * stride + x + 1] + row;
+		}
+	}
+	dirty = false;
+}
+
+int DensityGrid::CountRow(int y, int x0, int x1)
+{
+	if (x0 > x1) return 0;
+	const int stride = columns + 1;
+	return table[(y + 1) * stride + x1 + 1] - table[y * stride + x1 + 1]
+		 - table[(y + 1) * stride + x0] + table[y * stride + x0];
+}
+
+int DensityGrid::Count(const Vector2& location, double radius, double range, bool exact)
+{
+	if (dirty)
+		BuildTable();
+
+	const double reach = range + radius;
+	if (reach <= 0)
+		return 0;
+
+	int count = 0;
+
+	for (int y = CellY(location.y - reach); y <= CellY(location.y + reach); y++) {
+		const double top = y * DENSITY_CELL_SIZE, bottom = top + DENSITY_CELL_SIZE;
+
+		if (!exact) {
+			// the cells with the center inside
+			const double dy = top + DENSITY_CELL_SIZE / 2 - location.y;
+			if (std::abs(dy) >= reach) continue;
+			const double half = std::sqrt(reach * reach - dy * dy);
+			const int x0 = std::max(0, (int)std::ceil((location.x - half) / DENSITY_CELL_SIZE - 0.5));
+			const int x1 = std::min(columns - 1, (int)std::floor((location.x + half) / DENSITY_CELL_SIZE - 0.5));
+			count += CountRow(y, x0, x1);
+			continue;
+		}
+
+		// the cells of the row that touch the disc
+		const double nearY = location.y < top ? top - location.y : (location.y > bottom ? location.y - bottom : 0);
+		if (nearY > reach + DENSITY_EPSILON) continue;
+		const double outer = std::sqrt(std::max(0.0, (reach + DENSITY_EPSILON) * (reach + DENSITY_EPSILON) - nearY * nearY));
+		const int x0 = CellX(location.x - outer), x1 = CellX(location.x + outer);
+
+		// and the ones completely inside (all the corners)
+		int inner0 = x1 + 1, inner1 = x1;
+		const double farY = std::max(std::abs(top - location.y), std::abs(bottom - location.y));
+		const double inside = reach - DENSITY_EPSILON;
+		if (farY < inside) {
+			const double half = std::sqrt(inside * inside - farY * farY);
+			inner0 = std::max(x0, (int)std::ceil((location.x - half) / DENSITY_CELL_SIZE));
+			inner1 = std::min(x1, (int)std::floor((location.x + half) / DENSITY_CELL_SIZE) - 1);
+			if (inner0 > inner1) {
+				inner0 = x1 + 1;
+				inner1 = x1;
+			}
+		}
+		count += CountRow(y, inner0, inner1);
+
+		for (int x = x0; x <= x1; x++) {
+			if (x >= inner0 && x <= inner1) continue;
+			for (Ship* ship : buckets[y * columns + x]) {
+				if (ship->location.DistanceTo(location) - radius < range)
+					count++;
+			}
+		}
+	}
+
+	return count;
+}
+
+void DensityGrid::Find(const Vector2& location, double range, std::vector<Ship*>& found) const
+{
+	found.clear();
+	for (int y = CellY(location.y - range); y <= CellY(location.y + range); y++) {
+		for (int x = CellX(location.x - range); x <= CellX(location.x + range); x++) {
+			for (Ship* ship : buckets[y * columns + x]) {
+				if (ship->location.DistanceTo(location) < range)
+					found.push_back(ship);
+			}
+		}
+	}
+}
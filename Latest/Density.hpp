@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "Vector2.hpp"
+
+class Ship;
+
+// size of the cells of the density grids
+const double DENSITY_CELL_SIZE = 8;
+
+/*
+	Ships bucketed in a coarse grid with a summed-area table of the counts, to count
+	the ships inside a disc without looping over all the ships.
+	Every row of cells of the disc is split in the cells completely inside (one lookup in
+	the table) and the cells crossed by the border, where the ships are checked one by one
+	(exact) or the cells are counted if their center is inside (approximate).
+	Add/Remove keep it up to date, the table is rebuilt on the next query.
+*/
+class DensityGrid {
+public:
+	DensityGrid();
+
+	void Clear(int map_width, int map_height);
+	// nothing happens if the ship is already in (or not in) the grid
+	void Add(Ship* ship);
+	void Remove(Ship* ship);
+	bool Contains(Ship* ship) const;
+
+	// ships with ship->location.DistanceTo(location) - radius < range
+	int Count(const Vector2& location, double radius, double range, bool exact = true);
+	// the ships with ship->location.DistanceTo(location) < range
+	void Find(const Vector2& location, double range, std::vector<Ship*>& found) const;
+
+private:
+	int CellX(double x) const;
+	int CellY(double y) const;
+	// ships in the cells [x0, x1] of the row y
+	int CountRow(int y, int x0, int x1);
+	void BuildTable();
+
+	int columns, rows;
+	std::vector<std::vector<Ship*>> buckets;
+	std::vector<int> table; // (rows + 1) x (columns + 1), ships above and to the left
+	bool dirty;
+};
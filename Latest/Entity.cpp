@@ -3,7 +3,7 @@
 #include "Instance.hpp"
 
 bool Entity::IsOur() {
-	return Instance::Get()->player_id == owner_id;
+	return instance->player_id == owner_id;
 }
 
 bool Entity::IsClose(const Entity* other, const double range) const
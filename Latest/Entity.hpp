@@ -3,15 +3,19 @@
 #include "Types.hpp"
 #include "Vector2.hpp"
 
+class Instance;
+
 class Entity {
 public:
-	Entity(EntityId id) : entity_id(id)
+	Entity(Instance* instance, EntityId id) : instance(instance), entity_id(id)
 	{
 	}
 
 	bool IsOur();
 	bool IsClose(const Entity* other, const double range) const;
 
+	Instance* instance; // the match this entity belongs to
+
 	Vector2 location;
 	EntityId entity_id;
 	PlayerId owner_id;
@@ -0,0 +1,203 @@
+#include "Fields.hpp"
+
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "Instance.hpp"
+
+const unsigned short FIELD_UNREACHABLE = 0xFFFF;
+
+DistanceFields::DistanceFields() : cell_size(FIELD_CELL_SIZE), columns(0), rows(0)
+{
+}
+
+void DistanceFields::Build(Instance* instance)
+{
+	// the parents must fit in an unsigned short
+	cell_size = FIELD_CELL_SIZE;
+	while (std::ceil(instance->map_width / cell_size) * std::ceil(instance->map_height / cell_size) > FIELD_UNREACHABLE)
+		cell_size *= 2;
+	columns = (int)std::ceil(instance->map_width / cell_size);
+	rows = (int)std::ceil(instance->map_height / cell_size);
+
+	std::vector<Planet*> planets;
+	for (auto& kv : instance->planets)
+		planets.push_back(kv.second);
+	std::sort(planets.begin(), planets.end(), [](const Planet* a, const Planet* b) {
+		return a->entity_id < b->entity_id;
+	});
+
+	obstacles.clear();
+	for (Planet* planet : planets)
+		obstacles.push_back({ planet->location, planet->radius + hlt::constants::FORECAST_FUDGE_FACTOR });
+
+	blocked.assign(columns * rows, false);
+	for (int cell = 0; cell < columns * rows; cell++) {
+		for (const Obstacle& obstacle : obstacles) {
+			if (Center(cell).DistanceTo(obstacle.location) < obstacle.radius) {
+				blocked[cell] = true;
+				break;
+			}
+		}
+	}
+
+	// the goals: the free cells of the docking rings and the corners
+	std::vector<std::vector<int>> goals;
+	planetFields.assign(planets.empty() ? 0 : planets.back()->entity_id + 1, -1);
+	for (Planet* planet : planets) {
+		planetFields[planet->entity_id] = goals.size();
+		goals.emplace_back();
+		for (int cell = 0; cell < columns * rows; cell++) {
+			if (!blocked[cell] && Center(cell).DistanceTo(planet->location) <= planet->radius + hlt::constants::DOCK_RADIUS)
+				goals.back().push_back(cell);
+		}
+	}
+	for (int corner = 0; corner < FIELD_CORNERS; corner++) {
+		const int x = corner % 2 == 0 ? 0 : columns - 1, y = corner / 2 == 0 ? 0 : rows - 1;
+		goals.emplace_back();
+		if (!blocked[y * columns + x])
+			goals.back().push_back(y * columns + x);
+	}
+
+	fields.assign(goals.size(), Field());
+
+	std::atomic<int> next_field(0);
+	auto worker = [&]() {
+		int i;
+		while ((i = next_field++) < (int)fields.size())
+			Solve(fields[i], goals[i]);
+	};
+
+	int threads = std::max(1, std::min((int)std::thread::hardware_concurrency(), (int)fields.size()));
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threads; i++)
+		workers.emplace_back(worker);
+	worker();
+	for (std::thread& t : workers)
+		t.join();
+
+	instance->logger.log() << "Distance fields: " << fields.size() << " fields of " << columns << "x" << rows << " cells, " << threads << " threads" << std::endl;
+}
+
+void DistanceFields::Solve(Field& field, const std::vector<int>& goals) const
+{
+	const int cells = columns * rows;
+	std::vector<float> g(cells, (float)INF);
+	std::vector<int> parent(cells);
+	for (int cell = 0; cell < cells; cell++)
+		parent[cell] = cell;
+
+	typedef std::pair<float, int> Entry;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+	for (int cell : goals) {
+		g[cell] = 0;
+		open.push({ 0.0f, cell });
+	}
+
+	const int dx[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+	const int dy[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+	while (!open.empty()) {
+		const Entry entry = open.top();
+		open.pop();
+		const int cell = entry.second;
+		if (entry.first > g[cell]) continue;
+
+		const int x = cell % columns, y = cell / columns;
+		for (int k = 0; k < 8; k++) {
+			const int nx = x + dx[k], ny = y + dy[k];
+			if (nx < 0 || ny < 0 || nx >= columns || ny >= rows) continue;
+			const int neighbour = ny * columns + nx;
+			if (blocked[neighbour]) continue;
+
+			// through the parent if there is nothing in the way, the paths only turn at the planets
+			int from = parent[cell];
+			if (from != cell && !InSight(from, neighbour))
+				from = cell;
+
+			const float distance = g[from] + (float)Center(from).DistanceTo(Center(neighbour));
+			if (distance < g[neighbour]) {
+				g[neighbour] = distance;
+				parent[neighbour] = from;
+				open.push({ distance, neighbour });
+			}
+		}
+	}
+
+	field.distances.resize(cells);
+	field.parents.resize(cells);
+	for (int cell = 0; cell < cells; cell++) {
+		field.distances[cell] = g[cell] >= INF ? FIELD_UNREACHABLE : (unsigned short)std::min(FIELD_UNREACHABLE - 1.0, std::round(g[cell] * FIELD_DISTANCE_SCALE));
+		field.parents[cell] = (unsigned short)parent[cell];
+	}
+}
+
+bool DistanceFields::InSight(int a, int b) const
+{
+	const Vector2 start = Center(a), ab = Center(b) - start;
+	const double length2 = ab.x * ab.x + ab.y * ab.y;
+
+	for (const Obstacle& obstacle : obstacles) {
+		const Vector2 ac = obstacle.location - start;
+		const double t = std::max(0.0, std::min(1.0, (ac.x * ab.x + ac.y * ab.y) / length2));
+		if ((start + ab * t).DistanceTo(obstacle.location) < obstacle.radius)
+			return false;
+	}
+	return true;
+}
+
+Vector2 DistanceFields::Center(int cell) const
+{
+	return { (cell % columns + 0.5) * cell_size, (cell / columns + 0.5) * cell_size };
+}
+
+int DistanceFields::CellAt(const Vector2& location) const
+{
+	const int x = (int)(location.x / cell_size), y = (int)(location.y / cell_size);
+	if (location.x < 0 || location.y < 0 || x >= columns || y >= rows)
+		return -1;
+	return y * columns + x;
+}
+
+int DistanceFields::PlanetField(EntityId planet) const
+{
+	return planet >= 0 && planet < planetFields.size() ? planetFields[planet] : -1;
+}
+
+int DistanceFields::CornerField(int corner) const
+{
+	return corner >= 0 && corner < FIELD_CORNERS && !fields.empty() ? fields.size() - FIELD_CORNERS + corner : -1;
+}
+
+double DistanceFields::PathDistance(int field, const Vector2& location) const
+{
+	const int cell = CellAt(location);
+	if (field == -1 || cell == -1 || blocked[cell])
+		return -1;
+
+	const int parent = fields[field].parents[cell];
+	if (fields[field].distances[parent] == FIELD_UNREACHABLE)
+		return -1;
+	return fields[field].distances[parent] / FIELD_DISTANCE_SCALE + location.DistanceTo(Center(parent));
+}
+
+bool DistanceFields::Waypoint(int field, const Vector2& location, Vector2& waypoint) const
+{
+	const int cell = CellAt(location);
+	if (field == -1 || cell == -1 || blocked[cell])
+		return false;
+
+	const int parent = fields[field].parents[cell];
+	const unsigned short distance = fields[field].distances[parent];
+	if (distance == 0 || distance == FIELD_UNREACHABLE)
+		return false;
+
+	// a close waypoint would stop the ship, it keeps going past it like in Routes::NextWaypoint
+	waypoint = Center(parent);
+	const double toWaypoint = location.DistanceTo(waypoint);
+	if (toWaypoint < hlt::constants::MAX_SPEED && toWaypoint > 0)
+		waypoint = location + (waypoint - location) * (hlt::constants::MAX_SPEED / toWaypoint);
+	return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+#include "Types.hpp"
+#include "Vector2.hpp"
+
+class Instance;
+
+// size of the cells of the distance fields (bigger if the map doesn't fit in 65536 cells)
+const double FIELD_CELL_SIZE = 2;
+// the distances are stored in 1/FIELD_DISTANCE_SCALE units
+const double FIELD_DISTANCE_SCALE = 16;
+// the ESCAPE corners, in the order of their tasks
+const int FIELD_CORNERS = 4;
+
+/*
+	Shortest paths around the planets from every cell of a coarse grid to the docking ring
+	of every planet and to the corners of the map, computed in Initialize on all the threads.
+	Every field is a multi-source any-angle Dijkstra (Theta*): a cell inherits the parent of
+	its neighbour when it can see it, so the parents are the points where the paths turn
+	and the distances are euclidean around the planets instead of following the grid.
+	A cell stores its distance and its parent in 4 bytes.
+*/
+class DistanceFields {
+public:
+	DistanceFields();
+
+	void Build(Instance* instance);
+
+	// -1 if there is no field
+	int PlanetField(EntityId planet) const;
+	int CornerField(int corner) const;
+
+	// length of the shortest path from the location to the goal of the field (-1 if unknown)
+	double PathDistance(int field, const Vector2& location) const;
+	// where the shortest path turns, false if the goal is in sight (or unknown)
+	bool Waypoint(int field, const Vector2& location, Vector2& waypoint) const;
+
+	double cell_size;
+
+private:
+	struct Obstacle {
+		Vector2 location;
+		double radius;
+	};
+	struct Field {
+		std::vector<unsigned short> distances; // FIELD_DISTANCE_SCALE units, 0xFFFF if unreachable
+		std::vector<unsigned short> parents;
+	};
+
+	// fills the field from the goal cells
+	void Solve(Field& field, const std::vector<int>& goals) const;
+	bool InSight(int a, int b) const;
+	Vector2 Center(int cell) const;
+	// -1 outside the grid
+	int CellAt(const Vector2& location) const;
+
+	int columns, rows;
+	std::vector<Obstacle> obstacles;
+	std::vector<bool> blocked;
+	std::vector<Field> fields;
+	std::vector<int> planetFields; // by planet id
+};
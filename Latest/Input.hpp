@@ -3,15 +3,41 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <cstdlib>
 
 namespace in {
-	static std::string GetString() {
-		std::string result;
-		std::getline(std::cin, result);
-		return result;
+	// reuses the memory of the line
+	static void GetString(std::string& result, std::istream& stream = std::cin) {
+		std::getline(stream, result);
 	}
 
-	static std::stringstream GetSString() {
-		return std::stringstream(GetString());
-	}
+	// reads numbers from a line, std::stringstream allocates memory for every double
+	class Parser {
+	public:
+		Parser(const std::string& line) : ptr(line.c_str()) { }
+
+		Parser& operator>>(int& value) {
+			char* end;
+			value = (int)std::strtol(ptr, &end, 10);
+			ptr = end;
+			return *this;
+		}
+
+		Parser& operator>>(unsigned int& value) {
+			char* end;
+			value = (unsigned int)std::strtoul(ptr, &end, 10);
+			ptr = end;
+			return *this;
+		}
+
+		Parser& operator>>(double& value) {
+			char* end;
+			value = std::strtod(ptr, &end);
+			ptr = end;
+			return *this;
+		}
+
+	private:
+		const char* ptr;
+	};
 }
\ No newline at end of file
@@ -11,67 +11,77 @@
 #include <string.h>
 #include <algorithm>
 
-Instance* Instance::s_Instance = nullptr;
-std::vector<std::string> Stopwatch::messages;
+// the lowest adjustment that the priority calculation in AssignTasks can apply to the distance
+// (ATTACK to an indefense ship: -5 -5 -15 -25), keep it in sync!
+const double MIN_PRIORITY_ADJUSTMENT = -50;
 
-Instance::Instance()
+Instance::Instance() : admission(logger)
 {
-	s_Instance = this;
 }
 
 void Instance::Initialize(const std::string& bot_name)
 {
 	std::cout.sync_with_stdio(false);
 
-	in::GetSString() >> player_id;
-	in::GetSString() >> map_width >> map_height;
+	rush_phase = true;
+	game_over = false;
+	writing = false;
+
+	in::GetString(input, *in_stream);
+	if (recording.is_open()) recording << input << '\n';
+	in::Parser(input) >> player_id;
+
+	in::GetString(input, *in_stream);
+	if (recording.is_open()) recording << input << '\n';
+	in::Parser(input) >> map_width >> map_height;
 
-	Log::Get()->Open(std::to_string(player_id) + "_" + bot_name + ".log");
+	logger.Open(std::to_string(player_id) + "_" + bot_name + ".log");
 
-	Log::log() << "-- " << bot_name << " --" << std::endl;
-	Log::log() << "Our player id: " << player_id << std::endl;
-	Log::log() << "Map size: " << map_width << "x" << map_height << std::endl;
+	logger.log() << "-- " << bot_name << " --" << std::endl;
+	logger.log() << "Our player id: " << player_id << std::endl;
+	logger.log() << "Map size: " << map_width << "x" << map_height << std::endl;
+#ifdef HALITE_LOCAL
+	// the tables are built by the compiler, the runtime is the reference
+	logger.log() << "Trig tables: " << Tables::CountDifferences(0) << " values different from std::sin/std::cos, " << Tables::CountDifferences(1) << " by more than one ulp" << std::endl;
+#endif
 
 	turn = 0;
 	NextTurn();
 
-	Log::log() << "Players: " << num_players << std::endl
+	logger.log() << "Players: " << num_players << std::endl
 			   << "Planets: " << planets.size() << std::endl;
 
-	std::cout << bot_name << std::endl;
+	// -- Init 60 seconds (until we send the name) --
 
-	// -- Init 60 seconds --
+	map = new Map(this);
+	map->ClearMap(); // the layers are not initialized
+	map->FillMap(); // to calculate the message offset
 
-	for(int angle_deg = 0; angle_deg < 360; angle_deg++){
-		for (int thrust = 0; thrust < hlt::constants::MAX_SPEED * 2; thrust++) {
-			velocityCache[angle_deg][thrust] = Vector2::Velocity((angle_deg * M_PI) / 180.0, thrust);
-		}
+	{
+		Stopwatch s(this, "Routes");
+		routes.Build(this);
+	}
+	{
+		Stopwatch s(this, "Distance fields");
+		fields.Build(this);
 	}
-
-	map = new Map();
-	map->FillMap(); // to calculate the message offset
 
 	// MessageOffset calculation
 	{
-		Stopwatch s("MessageOffset calculation");
+		Stopwatch s(this, "MessageOffset calculation");
 
 		const Vector2 messageSize = { 140, 22 }; // aprox, calculated in Chlorine
 		const Vector2 center = { map_width / 2.0, map_height / 2.0 };
 		const double borderSeparation = 8; // to avoid annoy the players praying for the 3rd place
 
-		// this is very slow, maybe this can be done with DP, but we have 60s of init time that I'm not using... and.. of course, I'm lazy af
+		// every rectangle is one lookup in the summed-area table of the planets
+		map->BuildSolidTable();
 		messageOffset = { -1,-1 };
 		double minDist = INF;
 
 		for (int x = borderSeparation; x < map_width - messageSize.x - borderSeparation; x++) {
 			for (int y = borderSeparation; y < map_height - messageSize.y - borderSeparation; y++) {
-				bool blocked = false;
-				for (int xx = 0; !blocked && xx < messageSize.x; xx++) {
-					for (int yy = 0; !blocked && yy < messageSize.y; yy++) {
-						if (map->cells[(y + yy) * MAP_DEFINITION][(x + xx) * MAP_DEFINITION].solid)
-							blocked = true;
-					}
-				}
+				const bool blocked = !map->IsAreaFree({ (double)x, (double)y }, { x + messageSize.x - 1, y + messageSize.y - 1 });
 				if (!blocked) {
 					const Vector2 offset = { (double)x, (double)y };
 					const double dist = (offset + messageSize / 2.0).DistanceTo(center);
@@ -96,67 +106,62 @@ void Instance::Initialize(const std::string& bot_name)
 			messageOffset = { map_width / 2.0 - messageSize.x / 2.0, map_height / 2.0 + middlePlanetRadius * 2 + 7 };
 		}
 	}
+
+	*out_stream << bot_name << std::endl;
 }
 
 void Instance::Play()
 {
-	rush_phase = true;
-	game_over = false;
-	writing = false;
-
-	while (true) {
-		NextTurn();
+	while (NextTurn()) {
 
 		std::vector<Move> moves;
 		{
-			Stopwatch s("Turn took");
+			Stopwatch s(this, "Turn took");
 			moves = Frame();
 		}
 
-		Stopwatch::FlushMessages();
+		FlushTimings();
 
-		// generate moves string
-		std::ostringstream oss;
-		for (const Move& move : moves) {
-			switch (move.type) {
-			case MoveType::Noop:
-				continue;
-			case MoveType::Undock:
-				oss << "u " << move.ship_id << " ";
-				break;
-			case MoveType::Dock:
-				oss << "d " << move.ship_id << " "
-					<< move.dock_to << " ";
-				break;
-			case MoveType::Thrust:
-				oss << "t " << move.ship_id << " "
-					<< move.move_thrust << " "
-					<< move.move_angle_deg << " ";
-				break;
-			}
-		}
-		std::cout << oss.str() << std::endl;
+		std::string movesString = SerializeMoves(moves);
+		if (recording.is_open()) recording << movesString << std::endl; // the engine may kill us, flush every turn
+
+		*out_stream << movesString << std::endl;
 
-		if (!std::cout.good()) {
-			Log::log("Error sending movements, aborting");
-			std::exit(0);
+		if (!out_stream->good()) {
+			logger.log("Error sending movements, aborting");
+			return;
 		}
+
+		// the engine timer starts now, use the wait
+		StartSpeculation();
 	}
+
+	FinishSpeculation();
 }
 
-void Instance::NextTurn()
+bool Instance::NextTurn()
 {
-	const std::string input = in::GetString();
+	in::GetString(input, *in_stream);
 
-	if (!std::cin.good()) {
+	if (!in_stream->good()) {
 		// This is needed on Windows to detect that game engine is done.
-		std::exit(0);
+		return false;
 	}
 
+	if (recording.is_open()) recording << input << '\n';
+
+	BeginTurn(input);
+	return true;
+}
+
+void Instance::BeginTurn(const std::string& input)
+{
+	FinishSpeculation();
+
 	if (turn == 0)
-		Log::log("--- PRE-GAME ---");
+		logger.log("--- PRE-GAME ---");
 	else
-		Log::log() << "--- TURN " << turn << " ---" << std::endl;
+		logger.log() << "--- TURN " << turn << " ---" << std::endl;
 	turn_start = std::chrono::high_resolution_clock::now();
 
 	// process the map
@@ -165,8 +170,64 @@ void Instance::NextTurn()
 	++turn;
 }
 
+void Instance::StartSpeculation()
+{
+	FinishSpeculation();
+
+	// the planets don't move and the docked enemies most likely stay docked,
+	// everything else depends on the next frame and the navigation
+	std::vector<SolidPlanet> solids = map->CurrentPlanets();
+	std::vector<DockedStamp> dockedEnemies;
+	for (auto& kv : ships) {
+		Ship* ship = kv.second;
+		if (!ship->IsOur() && ship->docking_status == ShipDockingStatus::Docked)
+			dockedEnemies.push_back({ ship->entity_id, ship->owner_id, ship->location });
+	}
+
+	// only the map is touched, the main thread is blocked reading the input until BeginTurn joins
+	speculation = std::thread([this, solids, dockedEnemies]() {
+		map->PrepareNextTurn(solids, dockedEnemies);
+	});
+}
+
+void Instance::FinishSpeculation()
+{
+	if (speculation.joinable())
+		speculation.join();
+}
+
+void Instance::Record(const std::string& path)
+{
+	// the init lines, then the input of every turn followed by our moves
+	recording.open(path, std::ios::out);
+}
+
+std::string Instance::SerializeMoves(const std::vector<Move>& moves)
+{
+	std::ostringstream oss;
+	for (const Move& move : moves) {
+		switch (move.type) {
+		case MoveType::Noop:
+			continue;
+		case MoveType::Undock:
+			oss << "u " << move.ship_id << " ";
+			break;
+		case MoveType::Dock:
+			oss << "d " << move.ship_id << " "
+				<< move.dock_to << " ";
+			break;
+		case MoveType::Thrust:
+			oss << "t " << move.ship_id << " "
+				<< move.move_thrust << " "
+				<< move.move_angle_deg << " ";
+			break;
+		}
+	}
+	return oss.str();
+}
+
 void Instance::ParseMap(const std::string& input) {
-	std::stringstream iss(input);
+	in::Parser iss(input);
 
 	iss >> num_players;
 
@@ -192,12 +253,13 @@ void Instance::ParseMap(const std::string& input) {
 
 			Ship* ship = GetShip(entity_id);
 			if (ship == nullptr) {
-				ship = new Ship(entity_id);
+				ship = new Ship(this, entity_id);
 				ships.insert(std::make_pair(entity_id, ship));
 			}
 
 			ship->alive = true;
 			ship->frozen = true;
+			ship->last_task_id = ship->task_id;
 			ship->task_id = -1;
 			ship->task_priority = -INF;
 			ship->closest_defend_ship = 0;
@@ -229,7 +291,7 @@ void Instance::ParseMap(const std::string& input) {
 
 		Planet* planet = GetPlanet(entity_id);
 		if (planet == nullptr) {
-			planet = new Planet(entity_id);
+			planet = new Planet(this, entity_id);
 			planets.insert(std::make_pair(entity_id, planet));
 		}
 
@@ -297,14 +359,19 @@ void Instance::ParseMap(const std::string& input) {
 			myShips.push_back(ship);
 	}
 
-	Log::log() << "Map parsed -- ships: " << ships.size() << " planets: " << planets.size() << std::endl;
-}
+	// no ship has a task yet
+	enemiesDensity.Clear(map_width, map_height);
+	friendsDensity.Clear(map_width, map_height);
+	for (auto& kv : ships) {
+		Ship* ship = kv.second;
+		if (ship->IsCommandable())
+			(ship->IsOur() ? friendsDensity : enemiesDensity).Add(ship);
+	}
 
-Instance* Instance::Get()
-{
-	return s_Instance;
+	logger.log() << "Map parsed -- ships: " << ships.size() << " planets: " << planets.size() << std::endl;
 }
 
+
 Ship* Instance::GetShip(EntityId shipId) {
 	auto it = ships.find(shipId);
 	if (it != ships.end())
@@ -319,21 +386,69 @@ Planet* Instance::GetPlanet(EntityId planetId) {
 	return nullptr;
 }
 
-Task* Instance::CreateTask(TaskType type)
+static long long TaskKey(TaskType type, EntityId key)
 {
-	Task* task = new Task(current_task++);
-	task->type = type;
-	tasks.push_back(task);
+	return ((long long)type << 32) | (unsigned int)key;
+}
+
+Task* Instance::UpdateTask(TaskType type, EntityId key)
+{
+	Task* task;
+
+	auto it = taskRegistry.find(TaskKey(type, key));
+	if (it != taskRegistry.end())
+		task = (*it).second;
+	else {
+		task = new Task(tasksById.size(), type, key);
+		tasksById.push_back(task);
+		taskRegistry.insert(std::make_pair(TaskKey(type, key), task));
+		tasks.push_back(task);
+	}
+
+	if (task->last_update != task_generation) {
+		// first update this turn, reset what is computed every turn
+		task->last_update = task_generation;
+		task->ships.clear();
+		task->defendingDistance = INF;
+	}
+
 	return task;
 }
 
+Task* Instance::FindTask(TaskType type, EntityId key)
+{
+	auto it = taskRegistry.find(TaskKey(type, key));
+	if (it != taskRegistry.end() && (*it).second->last_update == task_generation)
+		return (*it).second;
+	return nullptr;
+}
+
 Task* Instance::GetTask(unsigned int task_id)
 {
-	return tasks.at(task_id);
+	if (task_id < tasksById.size())
+		return tasksById[task_id];
+	return nullptr;
+}
+
+void Instance::RetireTasks()
+{
+	// the tasks not updated this turn are gone (the planet changed owner, the ship died...)
+	auto alive = std::remove_if(tasks.begin(), tasks.end(), [&](Task* task) {
+		if (task->last_update == task_generation)
+			return false;
+		taskRegistry.erase(TaskKey(task->type, task->key));
+		tasksById[task->task_id] = nullptr;
+		delete task;
+		return true;
+	});
+	tasks.erase(alive, tasks.end());
 }
 
 std::vector<Move> Instance::Frame()
 {
+	// everything allocated in the last turn is gone
+	arena.Reset();
+
 	if (num_players == 4) {
 		// check for a game over
 		if (!game_over) {
@@ -363,7 +478,7 @@ std::vector<Move> Instance::Frame()
 		}
 	}
 	if (rush_phase) { // we check if the rush phase should end
-		Log::log("We're in rush phase!");
+		logger.log("We're in rush phase!");
 
 		bool threatsFound = false;
 
@@ -379,13 +494,13 @@ std::vector<Move> Instance::Frame()
 		if (threatsFound) {
 			if ((planetsCount.at(player_id) >= 1 && shipsCount.at(player_id) >= 6)) {
 				// just end the rushing detection phase if we generated at least 4 ships with a planet
-				Log::log("Ending the rush phase because we have at least 4 ships");
+				logger.log("Ending the rush phase because we have at least 4 ships");
 				threatsFound = false;
 			}
 		}
 
 		rush_phase = threatsFound;
-		Log::log() << "Rushing detection: " << (rush_phase ? "Continues" : "Ended") << std::endl;
+		logger.log() << "Rushing detection: " << (rush_phase ? "Continues" : "Ended") << std::endl;
 	}
 	if (!writing) {
 		if (shipsCount.at(player_id) > 90) { // we should have at least 90 ships to write
@@ -408,14 +523,14 @@ std::vector<Move> Instance::Frame()
 	});
 
 	std::vector<Move> moves;
-	std::vector<NavigationRequest*> navigationRequests;
+	ArenaVector<NavigationRequest*> navigationRequests(&arena);
+	navigationRequests.reserve(myShips.size());
 
 	{
-		Stopwatch s("Compute " + std::to_string(myShips.size()) + " actions");
+		Stopwatch s(this, "Compute " + std::to_string(myShips.size()) + " actions");
 		for (Ship* ship : myShips) {
 			auto action = ship->ComputeAction();
 			if (action.second.second) {
-				ship->frozen = false;
 				navigationRequests.push_back(action.second.first);
 			}
 			else {
@@ -426,36 +541,55 @@ std::vector<Move> Instance::Frame()
 		}
 	}
 
-	const int MAX_SHIPS = 250;
-	if (navigationRequests.size() > MAX_SHIPS) { // thats too much
-		// sort the nav requests by importance
-		std::sort(navigationRequests.begin(), navigationRequests.end(), [&](const NavigationRequest* a, const NavigationRequest* b) {
-			const Task* taskA = GetTask(a->ship->task_id);
-			const Task* taskB = GetTask(b->ship->task_id);
-
-			if (taskA && !taskB) return true; // a
-			else if (!taskA && taskB) return false; // b
-			else if (!taskA && !taskB) return true; // anywho
-			else {
-				if (taskA->type == taskB->type)
-					return a->ship->task_priority > b->ship->task_priority;
-				else
-					return taskA->type > taskB->type;
-			}
-		});
+	// the ships that may fight next turn need the full navigation
+	for (NavigationRequest* navReq : navigationRequests) {
+		navReq->near_combat = CountNearbyShips(navReq->ship->location, navReq->ship->radius, COMBAT_RANGE, false) > 0;
 	}
-	std::set<NavigationRequest*> navigationRequestsSet;
-	for (int i = 0; i < std::min(MAX_SHIPS, (int)navigationRequests.size()); i++) {
+
+	// sort the nav requests by importance
+	std::sort(navigationRequests.begin(), navigationRequests.end(), [&](const NavigationRequest* a, const NavigationRequest* b) {
+		if (a->near_combat != b->near_combat)
+			return a->near_combat;
+
+		const Task* taskA = GetTask(a->ship->task_id);
+		const Task* taskB = GetTask(b->ship->task_id);
+
+		if (taskA && !taskB) return true; // a
+		else if (!taskA && taskB) return false; // b
+		else if (!taskA && !taskB) return true; // anywho
+		else {
+			if (taskA->type == taskB->type)
+				return a->ship->task_priority > b->ship->task_priority;
+			else
+				return taskA->type > taskB->type;
+		}
+	});
+
+	// navigate as many requests as the remaining time allows
+	int admitted = admission.Admit(navigationRequests, MAX_TIME - CurrentTurnTime());
+	map->definition = admission.definition;
+
+	NavigationRequestSet navigationRequestsSet(&arena);
+	for (int i = 0; i < admitted; i++) {
+		navigationRequests[i]->ship->frozen = false;
 		navigationRequestsSet.insert(navigationRequests[i]);
 	}
 
-	std::vector<Move> navMoves = Navigation::NavigateShips(navigationRequestsSet);
+	auto navigation_start = std::chrono::high_resolution_clock::now();
+	std::vector<Move> navMoves = Navigation::NavigateShips(this, navigationRequestsSet);
+	std::chrono::duration<double, std::milli> navigation_elapsed = std::chrono::high_resolution_clock::now() - navigation_start;
 
-	for (NavigationRequest* navReq : navigationRequests)
-		delete navReq;
-	navigationRequests.clear();
+	admission.Observe(admitted, admission.admitted_edges, navigation_elapsed.count(), CurrentTurnTime() > MAX_TIME);
+
+	// the ships that didn't fit use the cheap navigation
+	ArenaVector<NavigationRequest*> fallbackRequests(navigationRequests.begin() + admitted, navigationRequests.end(), &arena);
+	std::vector<Move> fallbackMoves = Navigation::NavigateFallback(this, fallbackRequests, navMoves);
+	navMoves.insert(navMoves.end(), fallbackMoves.begin(), fallbackMoves.end());
 
-	Log::log() << "Navigation requests: " << navigationRequests.size() << " Navigation moves: " << navMoves.size() << std::endl;
+	logger.log() << "Navigation requests: " << navigationRequests.size() << " Navigation moves: " << navMoves.size() << " (fallback: " << fallbackMoves.size() << ")" << std::endl;
+
+	// the requests are released with the arena
+	navigationRequests.clear();
 
 	for (Move navMove : navMoves) {
 		// Add a message in the angle (for Chlorine)
@@ -472,21 +606,16 @@ std::vector<Move> Instance::Frame()
 
 void Instance::GenerateTasks()
 {
-	Stopwatch s("Generate tasks");
+	Stopwatch s(this, "Generate tasks");
 
-	// Clear old tasks
-	current_task = 0;
-	for (Task* task : tasks)
-		delete task;
-	tasks.clear();
-
-	// Generate new tasks
+	// Update the tasks, the ones that are not updated are retired at the end
+	task_generation++;
 	for (auto& kv : planets) {
 		Planet* planet = kv.second;
 
 		if (planet->owner_id == -1 || planet->IsOur()) { // the planet is not owned or it's owned by us
 			// Task DOCK
-			Task* taskDock = CreateTask(TaskType::DOCK);
+			Task* taskDock = UpdateTask(TaskType::DOCK, planet->entity_id);
 			taskDock->target = planet->entity_id;
 			taskDock->location = planet->location;
 			taskDock->radius = planet->radius;
@@ -496,7 +625,6 @@ void Instance::GenerateTasks()
 
 	if (!game_over) {
 		// Defend tasks
-		std::vector<Task*> defendTasks;
 		for (Ship* ship : myShips) {
 			if (ship->IsOur() && !ship->IsCommandable()) {
 				Ship* enemyShip = GetClosestShip(ship->location, false);
@@ -505,20 +633,9 @@ void Instance::GenerateTasks()
 
 				double distance = ship->location.DistanceTo(enemyShip->location);
 				if (distance < hlt::constants::MAX_SPEED + hlt::constants::WEAPON_RADIUS + 1) {
-					Task* taskDefend = 0;
-					for (Task* td : defendTasks) {
-						if (td->defendingFromShip == enemyShip) {
-							taskDefend = td;
-							break;
-						}
-					}
-
-					if (taskDefend == 0) {
-						taskDefend = CreateTask(TaskType::DEFEND);
-						taskDefend->target = -1;
-						taskDefend->radius = 0;
-						defendTasks.push_back(taskDefend);
-					}
+					Task* taskDefend = UpdateTask(TaskType::DEFEND, enemyShip->entity_id);
+					taskDefend->target = -1;
+					taskDefend->radius = 0;
 
 					if (distance < taskDefend->defendingDistance) {
 						taskDefend->defendingDistance = distance;
@@ -536,13 +653,7 @@ void Instance::GenerateTasks()
 			if (ship->IsOur()) continue;
 			// every enemy ship alive
 
-			bool in_defend_task = false;
-			for (Task* td : defendTasks) {
-				if (td->defendingFromShip == ship) {
-					in_defend_task = true;
-					break;
-				}
-			}
+			bool in_defend_task = FindTask(TaskType::DEFEND, ship->entity_id) != nullptr;
 			if (in_defend_task) continue;
 
 			if (num_players == 4 && turn > 50 && planetsCount.at(player_id) > 0 && planetsCount.at(ship->owner_id) == 0) {
@@ -563,7 +674,7 @@ void Instance::GenerateTasks()
 					continue;
 			}
 
-			Task* taskAttack = CreateTask(TaskType::ATTACK);
+			Task* taskAttack = UpdateTask(TaskType::ATTACK, ship->entity_id);
 			taskAttack->target = ship->entity_id;
 			taskAttack->location = ship->location;
 			taskAttack->radius = 0;
@@ -578,8 +689,6 @@ void Instance::GenerateTasks()
 			}
 		}
 
-		defendTasks.clear();
-
 		if (writing) {
 			const Vector2 writeMessagePoints[] = {
 				// H
@@ -641,7 +750,7 @@ void Instance::GenerateTasks()
 			const double scale = 7;
 
 			for (int i = 0; i < writeMessagePointsCount; i++) {
-				Task* writeTask = CreateTask(TaskType::WRITE);
+				Task* writeTask = UpdateTask(TaskType::WRITE, i);
 				writeTask->target = -1;
 				writeTask->location = messageOffset + writeMessagePoints[i] * scale;
 				writeTask->radius = 0;
@@ -653,7 +762,7 @@ void Instance::GenerateTasks()
 		// we've lost
 		// try to get 3rd place
 		for (int i = 0; i < 4; i++) {
-			Task* taskEscape = CreateTask(TaskType::ESCAPE);
+			Task* taskEscape = UpdateTask(TaskType::ESCAPE, i);
 			taskEscape->target = -1;
 			taskEscape->location = { i % 2 == 0 ? 0 : (double)map_width, (int)(i / 2.0) == 0 ? 0 : (double)map_height };
 			taskEscape->radius = 0;
@@ -661,32 +770,30 @@ void Instance::GenerateTasks()
 		}
 	}
 
-	Log::log() << "Generated " << tasks.size() << " tasks" << std::endl;
+	RetireTasks();
+
+	logger.log() << "Generated " << tasks.size() << " tasks (created so far: " << tasksById.size() << ")" << std::endl;
 }
 
 void Instance::AssignTasks()
 {
-	Stopwatch s("Assign tasks");
+	Stopwatch s(this, "Assign tasks");
 
-	std::queue<Ship*> qShips;
+	std::deque<Ship*, ArenaAllocator<Ship*>> qShipsContainer(&arena);
+	std::queue<Ship*, std::deque<Ship*, ArenaAllocator<Ship*>>> qShips(std::move(qShipsContainer));
 
 	// non undocked ships have a fixed task
 	for (Ship* ship : myShips) {
 		if (!ship->IsCommandable()) {
 			// ship is docking, docked or undocking
 
-			Task* dockTask = 0;
-
 			// we're docked to a planet, find the task that match
-			for (Task* task : tasks) {
-				if (task->type == TaskType::DOCK && task->target == ship->docked_planet) {
-					dockTask = task;
-					break;
-				}
-			}
+			Task* dockTask = FindTask(TaskType::DOCK, ship->docked_planet);
 
 			if (dockTask == 0) {
-				Log::log("Dock task for ship " + std::to_string(ship->entity_id) + " not found.");
+#ifdef HALITE_LOCAL // only build the string if it will be logged
+				logger.log("Dock task for ship " + std::to_string(ship->entity_id) + " not found.");
+#endif
 			}
 			else {
 				std::string status_name = "?";
@@ -697,11 +804,13 @@ void Instance::AssignTasks()
 				case ShipDockingStatus::Undocking: status_name = "UNDOCKING"; break;
 				}
 
-				Log::log("Ship " + std::to_string(ship->entity_id) + " continues " + status_name + " to planet " + std::to_string(dockTask->target) + " -- docking progress: " + std::to_string(ship->docking_progress));
+#ifdef HALITE_LOCAL
+				logger.log("Ship " + std::to_string(ship->entity_id) + " continues " + status_name + " to planet " + std::to_string(dockTask->target) + " -- docking progress: " + std::to_string(ship->docking_progress));
+#endif
 
 				ship->task_id = dockTask->task_id;
 				ship->task_priority = INF; // docked ships cant be relevated
-				dockTask->ships.insert(ship);
+				dockTask->AddShip(ship);
 			}
 		}
 		if (ship->task_id == -1) {
@@ -718,7 +827,7 @@ void Instance::AssignTasks()
 						int enemies = CountNearbyShips(ship->location, ship->radius, 13, false);
 						int friends = CountNearbyShips(ship->location, ship->radius, 13, true);
 						if (ship->health - enemies * (64.0 / friends) <= 0) {
-							Task* taskSuicide = CreateTask(TaskType::SUICIDE);
+							Task* taskSuicide = UpdateTask(TaskType::SUICIDE, enemyShip->entity_id);
 							taskSuicide->target = enemyShip->entity_id;
 							taskSuicide->location = enemyShip->location;
 							taskSuicide->radius = 0;
@@ -726,7 +835,7 @@ void Instance::AssignTasks()
 
 							ship->task_id = taskSuicide->task_id;
 							ship->task_priority = INF;
-							taskSuicide->ships.insert(ship);
+							taskSuicide->AddShip(ship);
 						}
 					}
 				}
@@ -739,7 +848,7 @@ void Instance::AssignTasks()
 		}
 	}
 
-	std::set<Ship*> unsuitableShips;
+	ArenaSet<Ship*> unsuitableShips(&arena);
 
 	// for the rest of the ships (which are now on qShips)
 	while (!qShips.empty()) {
@@ -750,16 +859,27 @@ void Instance::AssignTasks()
 		double maxPriority = -INF;
 		Ship* otherShipPtrOverriding = 0;
 
-		for (Task* task : tasks) {
+		// the task of the last turn goes first, it's usually still the best one
+		// and it makes the bound below discard most of the other tasks
+		Task* previousTask = GetTask(ship->last_task_id);
+
+		for (int i = -1; i < (int)tasks.size(); i++) {
+			Task* task = i == -1 ? previousTask : tasks[i];
+			if (task == 0 || (i != -1 && task == previousTask)) continue;
 			if (task->max_ships == 0) continue;
 
 			//if (task->type != ATTACK) continue; // rusher bot for testing
 
+			double distance = ship->location.DistanceTo(task->location);
+
+			// the priority calculation can't lower d more than MIN_PRIORITY_ADJUSTMENT,
+			// so if even that can't beat the best task we skip the expensive part
+			if (100 - (distance + MIN_PRIORITY_ADJUSTMENT) / 100 < maxPriority) continue;
+
 			// this is a priority relative to the ship, aka how important this task is for this ship
 			Vector2 target = task->location;
 			if (task->radius != 0)
 				target = ship->location.ClosestPointTo(task->location, task->radius);
-			double distance = ship->location.DistanceTo(task->location);
 
 			/* PRIORITY CALCULATION */
 			double d = distance;
@@ -769,6 +889,11 @@ void Instance::AssignTasks()
 			{
 				d += 5;
 
+				// the planets in the way (the cells of the field are worth one cell of error)
+				double path = fields.PathDistance(fields.PlanetField(task->target), ship->location);
+				if (path >= 0)
+					d += std::max(0.0, path - std::max(0.0, distance - task->radius - hlt::constants::DOCK_RADIUS) - fields.cell_size);
+
 				int min_side = std::min(map_width, map_height);
 				double planetDistanceFromCenter = task->location.DistanceTo({ map_width / 2.0, map_height / 2.0 });
 				d -= (planetDistanceFromCenter / (double)min_side) * 15;
@@ -779,25 +904,10 @@ void Instance::AssignTasks()
 				
 				if (distance < 10) {
 					int enemies = CountNearbyShips(target, 0, 22, false);
-					int friends = 0;
-					for (Ship* shipOther : myShips) {
-						if (ship == shipOther) continue;
-						if (shipOther->IsCommandable()) {
-							double d = shipOther->location.DistanceTo(target);
-							if (d < 22) {
-								if (shipOther->task_id != -1) {
-									TaskType ttype = GetTask(shipOther->task_id)->type;
-									if (ttype == TaskType::DOCK)
-										continue;
-									if (ttype == TaskType::DEFEND) {
-										if (d > task->defendingDistance - 1)
-											continue;
-									}
-								}
-								friends++;
-							}
-						}
-					}
+					// the ships that aren't docking, except this one
+					int friends = CountNearbyShips(target, 0, 22, true);
+					if (friendsDensity.Contains(ship) && ship->location.DistanceTo(target) < 22)
+						friends--;
 					if (enemies != 0 && enemies > friends - 1) {
 						d += 1000; // we should not dock
 					}
@@ -861,16 +971,22 @@ void Instance::AssignTasks()
 		}
 
 		if (priorizedTask == 0) {
-			Log::log("Ship " + std::to_string(ship->entity_id) + " couldn't find a suitable task.");
+#ifdef HALITE_LOCAL
+			logger.log("Ship " + std::to_string(ship->entity_id) + " couldn't find a suitable task.");
+#endif
 			unsuitableShips.insert(ship);
 			continue;
 		}
 		
-		Log::log("Ship " + std::to_string(ship->entity_id) + " assigned to task " + std::to_string(priorizedTask->task_id) + " (" + priorizedTask->Info() + ") with priority " + std::to_string(maxPriority));
+#ifdef HALITE_LOCAL
+		logger.log("Ship " + std::to_string(ship->entity_id) + " assigned to task " + std::to_string(priorizedTask->task_id) + " (" + priorizedTask->Info() + ") with priority " + std::to_string(maxPriority));
+#endif
 
 		if (otherShipPtrOverriding) {
-			Log::log("... while overriding ship " + std::to_string(otherShipPtrOverriding->entity_id) + " in task " + std::to_string(otherShipPtrOverriding->task_id));
-			priorizedTask->ships.erase(otherShipPtrOverriding);
+#ifdef HALITE_LOCAL
+			logger.log("... while overriding ship " + std::to_string(otherShipPtrOverriding->entity_id) + " in task " + std::to_string(otherShipPtrOverriding->task_id));
+#endif
+			priorizedTask->RemoveShip(otherShipPtrOverriding);
 			qShips.push(otherShipPtrOverriding);
 			otherShipPtrOverriding->task_id = -1;
 			otherShipPtrOverriding->task_priority = 0;
@@ -878,10 +994,10 @@ void Instance::AssignTasks()
 
 		ship->task_id = priorizedTask->task_id;
 		ship->task_priority = maxPriority;
-		priorizedTask->ships.insert(ship);
+		priorizedTask->AddShip(ship);
 	}
 
-	Log::log() << "Unsuitable Ships: " << unsuitableShips.size() << std::endl;
+	logger.log() << "Unsuitable Ships: " << unsuitableShips.size() << std::endl;
 
 	while (unsuitableShips.size() != 0) {
 		bool atLeastOne = false;
@@ -908,7 +1024,7 @@ void Instance::AssignTasks()
 
 				closestShip->task_id = task->task_id;
 				closestShip->task_priority = 0;
-				task->ships.insert(closestShip);
+				task->AddShip(closestShip);
 				unsuitableShips.erase(closestShip);
 			}
 		}
@@ -919,35 +1035,12 @@ void Instance::AssignTasks()
 		}
 	}
 
-	Log::log() << "Tasks have been assigned" << std::endl;
+	logger.log() << "Tasks have been assigned" << std::endl;
 }
 
 int Instance::CountNearbyShips(Vector2 location, double radius, double range, bool friends)
 {
-	int count = 0;
-
-	if (friends) {
-		for (Ship* ship : myShips) {
-			if (ship->IsCommandable()) {
-				if (ship->task_id != -1 && GetTask(ship->task_id)->type == TaskType::DOCK)
-					continue;
-				if (ship->location.DistanceTo(location) - radius < range)
-					count++;
-			}
-		}
-	}
-	else {
-		for (auto& kv : ships) {
-			Ship* ship = kv.second;
-			if (ship->IsOur()) continue;
-			if (ship->IsCommandable()) {
-				if (ship->location.DistanceTo(location) - radius < range)
-					count++;
-			}
-		}
-	}
-
-	return count;
+	return (friends ? friendsDensity : enemiesDensity).Count(location, radius, range);
 }
 
 Ship* Instance::GetClosestShip(Vector2 location, bool friends)
@@ -981,9 +1074,9 @@ Ship* Instance::GetClosestShip(Vector2 location, bool friends)
 	return closest;
 }
 
-std::vector<Entity*> Instance::GetEntitiesInside(const Entity* entity, const double range)
+void Instance::GetEntitiesInside(const Entity* entity, const double range, std::vector<Entity*>& found)
 {
-	std::vector<Entity*> found;
+	found.clear();
 
 	for(auto& kv : planets) {
 		Planet* planet = kv.second;
@@ -997,8 +1090,6 @@ std::vector<Entity*> Instance::GetEntitiesInside(const Entity* entity, const dou
 			if(entity->IsClose(ship, range))
 				found.push_back(ship);
 	}
-
-	return found;
 }
 
 long long Instance::CurrentTurnTime()
@@ -1007,3 +1098,12 @@ long long Instance::CurrentTurnTime()
 	std::chrono::duration<double> elapsed = finish - turn_start;
 	return std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
 }
+
+void Instance::FlushTimings()
+{
+#if HALITE_LOCAL
+	for (auto& timing : timings)
+		logger.log(timing.first + ": " + std::to_string((long long)timing.second) + "ms");
+	timings.clear();
+#endif
+}
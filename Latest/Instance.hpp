@@ -5,6 +5,9 @@
 #include <string>
 #include <unordered_map>
 #include <chrono>
+#include <iostream>
+#include <fstream>
+#include <thread>
 
 #include "Types.hpp"
 #include "Move.hpp"
@@ -13,59 +16,48 @@
 #include "Task.hpp"
 #include "Map.hpp"
 #include "Log.hpp"
-
-class Stopwatch {
-public:
-	Stopwatch(const std::string& identifier) : identifier(identifier) {
-#if HALITE_LOCAL
-		start = std::chrono::high_resolution_clock::now();
-#endif
-	};
-
-	~Stopwatch() {
-#if HALITE_LOCAL
-		auto end = std::chrono::high_resolution_clock::now();
-		std::chrono::duration<double> elapsed = end - start;
-		long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
-
-		messages.push_back(identifier + ": " + std::to_string(ms) + "ms");
-#endif
-	}
-
-	std::string identifier;
-	std::chrono::time_point<std::chrono::high_resolution_clock> start;
-
-	static std::vector<std::string> messages;
-
-	static void FlushMessages() {
-#if HALITE_LOCAL
-		for (std::string s : messages) {
-			Log::log(s);
-		}
-		messages.clear();
-#endif
-	}
-};
-
-/* A Halite match instance */
+#include "Admission.hpp"
+#include "Arena.hpp"
+#include "Density.hpp"
+#include "Routes.hpp"
+#include "Fields.hpp"
+#include "Tables.hpp"
+
+/*
+	A Halite match instance
+	All the state of the bot lives here (and in the objects it owns), it is passed
+	explicitly to the ships, the map and the navigation, so many matches can run
+	at the same time in a process (one per thread)
+*/
 class Instance {
 public:
 	Instance();
 
-	static Instance* Get();
-
 	void Initialize(const std::string& bot_name);
+	// plays until the engine closes the input
 	void Play();
-	void NextTurn();
+	// false at the end of the input
+	bool NextTurn();
+	void BeginTurn(const std::string& input);
 	void ParseMap(const std::string& input);
 
+	// while we wait for the next frame a worker prepares the map (see Map::PrepareNextTurn)
+	void StartSpeculation();
+	void FinishSpeculation();
+
+	// dumps the input and our moves to a file that can be replayed with Replay.cpp
+	void Record(const std::string& path);
+	static std::string SerializeMoves(const std::vector<Move>& moves);
+
 	std::vector<Move> Frame();
 
 	Ship* GetShip(EntityId shipId);
 	Planet* GetPlanet(EntityId planetId);
 
-	Task* CreateTask(TaskType type = TaskType::NOTHING);
+	Task* UpdateTask(TaskType type, EntityId key);
+	Task* FindTask(TaskType type, EntityId key);
 	Task* GetTask(unsigned int task_id);
+	void RetireTasks();
 
 	void GenerateTasks();
 	void AssignTasks();
@@ -73,11 +65,14 @@ public:
 	// Useful functions
 	int CountNearbyShips(Vector2 location, double radius, double range, bool friends);
 	Ship* GetClosestShip(Vector2 location, bool friends);
-	std::vector<Entity*> GetEntitiesInside(const Entity* entity, const double range);
+	void GetEntitiesInside(const Entity* entity, const double range, std::vector<Entity*>& found);
 
 	// ms
 	long long CurrentTurnTime();
 
+	// logs the stopwatches of the turn and clears them
+	void FlushTimings();
+
 	PlayerId player_id;
 	unsigned int map_width, map_height;
 	unsigned int turn;
@@ -92,14 +87,34 @@ public:
 	std::unordered_map<PlayerId, int> shipsCount; // alive ships
 	std::unordered_map<PlayerId, int> planetsCount; // planets owned
 
+	// for CountNearbyShips, built every turn
+	DensityGrid enemiesDensity; // commandable enemies
+	DensityGrid friendsDensity; // our commandable ships not docking (see Task::AddShip)
+
+	Log logger;
+	std::vector<std::pair<std::string, double>> timings; // ms, filled by the stopwatches (HALITE_LOCAL)
+
 	Map* map;
 
-	// Cache
-	Vector2 velocityCache[360][hlt::constants::MAX_SPEED * 2];
+	// around the planets, built in Initialize
+	Routes routes;
+	DistanceFields fields;
+
+	// Cache, [angle][thrust] (built by the compiler, see Tables)
+	const Vector2 (*velocityCache)[TABLE_THRUSTS] = Tables::velocities.velocity;
+
+	// Memory for the objects that only live during the turn
+	Arena arena;
 
 	// Task System
-	std::vector<Task*> tasks;
-	unsigned int current_task = 0;
+	// the tasks persist between turns, they are keyed by (type, key) and updated in place
+	std::vector<Task*> tasks; // alive tasks
+	std::vector<Task*> tasksById; // null if retired
+	std::unordered_map<long long, Task*> taskRegistry;
+	unsigned int task_generation = 0; // incremented every GenerateTasks
+
+	// Navigation
+	AdmissionControl admission;
 
 	bool rush_phase;
 	bool writing;
@@ -108,6 +123,47 @@ public:
 
 	// Message
 	Vector2 messageOffset;
+
+	// I/O, the engine unless we are replaying
+	std::istream* in_stream = &std::cin;
+	std::ostream* out_stream = &std::cout;
 private:
-	static Instance* s_Instance;
+	std::string input; // last line received
+	std::ofstream recording;
+
+	std::thread speculation;
+};
+
+class Stopwatch {
+public:
+	Stopwatch(Instance* instance, const std::string& identifier) : instance(instance), identifier(identifier) {
+#if HALITE_LOCAL
+		start = std::chrono::high_resolution_clock::now();
+#endif
+	};
+
+	~Stopwatch() {
+#if HALITE_LOCAL
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		instance->timings.push_back(std::make_pair(identifier, elapsed.count()));
+#endif
+	}
+
+	Instance* instance;
+	std::string identifier;
+	std::chrono::time_point<std::chrono::high_resolution_clock> start;
+
+	// some identifiers have counts in them ("Compute 123 actions" -> "Compute N actions")
+	static std::string PhaseName(const std::string& identifier) {
+		std::string name;
+		for (char c : identifier) {
+			if (c >= '0' && c <= '9') {
+				if (name.empty() || name.back() != 'N')
+					name += 'N';
+			}
+			else
+				name += c;
+		}
+		return name;
+	}
 };
\ No newline at end of file
@@ -1,7 +1,5 @@
 #include "Log.hpp"
 
-Log* Log::s_Log = nullptr;
-
 Log::Log() {
 
 }
@@ -11,19 +9,13 @@ void Log::Open(const std::string& path)
 	file.open(path, std::ios::out);
 }
 
-Log* Log::Get() {
-	if (s_Log == nullptr)
-		s_Log = new Log();
-	return s_Log;
-}
-
 void Log::log(const std::string& str) {
 #ifdef HALITE_LOCAL
-	Get()->file << str << std::endl;
+	file << str << std::endl;
 #endif
 }
 
 std::ofstream& Log::log()
 {
-	return Get()->file;
+	return file;
 }
@@ -3,19 +3,16 @@
 #include <string>
 #include <fstream>
 
+/* The log of an instance (every match has its own file) */
 class Log {
 public:
 	Log();
 
 	void Open(const std::string& path);
 
-	static Log* Get();
-
-	static void log(const std::string& string);
-	static std::ofstream& log();
+	void log(const std::string& string);
+	std::ofstream& log();
 
 private:
 	std::ofstream file;
-
-	static Log* s_Log;
 };
\ No newline at end of file
@@ -3,31 +3,152 @@
 #include <string.h>
 #include <algorithm>
 #include <math.h>
+#include <thread>
 
 #include "Instance.hpp"
 #include "Navigation.hpp"
 #include "Image.hpp"
 
-Map::Map()
+void Map::IterationBounds(const Vector2& location, double radius, Vector2& startPoint, Vector2& endPoint)
+{
+	startPoint = location - radius;
+	endPoint = location + radius;
+
+	const double borderSeparation = 1;
+
+	startPoint.x = std::fmin(std::fmax(startPoint.x, borderSeparation), instance->map_width - borderSeparation);
+	startPoint.y = std::fmin(std::fmax(startPoint.y, borderSeparation), instance->map_height - borderSeparation);
+
+	endPoint.x = std::fmin(std::fmax(endPoint.x, borderSeparation), instance->map_width - borderSeparation);
+	endPoint.y = std::fmin(std::fmax(endPoint.y, borderSeparation), instance->map_height - borderSeparation);
+}
+
+template<typename Action>
+void Map::IterateMap(Vector2 location, double radius, Action action, int rowBegin, int rowEnd) {
+	Vector2 startPoint, endPoint;
+	IterationBounds(location, radius, startPoint, endPoint);
+
+	const double step = 1.0 / definition;
+
+	for (double ix = startPoint.x; ix <= endPoint.x; ix += step) {
+		for (double iy = startPoint.y; iy <= endPoint.y; iy += step) {
+			const int row = (int)(iy * definition);
+			if (row < rowBegin) continue;
+			if (row >= rowEnd) break;
+
+			Vector2 position = { (double)ix, (double)iy };
+			double d = location.DistanceTo(position);
+			if (d < radius) {
+				action(position, CellIndex(position), d);
+			}
+		}
+	}
+}
+
+Map::Map(Instance* instance) : instance(instance)
 {
 }
 
 void Map::ClearMap() {
-	memset(&cells[0][0], 0, MAP_HEIGHT * MAP_WIDTH * sizeof(MapCell));
+	// only the rows in use
+	const size_t used = std::min(MAP_HEIGHT, (int)instance->map_height * definition + 1) * (size_t)MAP_WIDTH;
+
+	solidCells.Clear();
+	shipCells.Clear();
+	memset(nextTurnEnemyShipsTakingDamage, 0, used * sizeof(MapCounter));
+	memset(nextTurnFriendlyShipsTakingDamage, 0, used * sizeof(MapCounter));
+	memset(nextTurnEnemyShipsAttackInRange, 0, used * sizeof(MapCounter));
+	memset(nextTurnFriendlyShipsAttackInRange, 0, used * sizeof(MapCounter));
+}
+
+void Map::MarkSolid(const Vector2& location, double radius, int rowBegin, int rowEnd)
+{
+	IterateMap(location, radius + hlt::constants::SHIP_RADIUS, [&](Vector2 position, int cell, double distance) {
+		solidCells.Set(cell);
+	}, rowBegin, rowEnd);
 }
 
 void Map::FillMap()
 {
-	Instance* instance = Instance::Get();
-	
-	// mark the planets as solids
+	// mark the planets as solids (they are big, every thread takes a band)
+	ForEachBand(std::thread::hardware_concurrency(), [&](int rowBegin, int rowEnd) {
+		for (auto&kv : instance->planets)
+			MarkSolid(kv.second->location, kv.second->radius, rowBegin, rowEnd);
+	});
+
+	FillShips(nullptr);
+}
+
+std::vector<SolidPlanet> Map::CurrentPlanets()
+{
+	std::vector<SolidPlanet> planets;
+	for (auto&kv : instance->planets)
+		planets.push_back({ kv.second->entity_id, kv.second->location, kv.second->radius });
+	std::sort(planets.begin(), planets.end(), [](const SolidPlanet& a, const SolidPlanet& b) {
+		return a.id < b.id;
+	});
+	return planets;
+}
+
+void Map::StampDocked(const DockedStamp& stamp, int direction)
+{
+	// like ModifyShip of a docked enemy: it can be hit and doesn't attack
+	IterateMap(stamp.location, hlt::constants::SHIP_RADIUS + hlt::constants::WEAPON_RADIUS, [&](Vector2 position, int cell, double distance) {
+		if (distance < hlt::constants::SHIP_RADIUS)
+			shipCells.Set(cell);
+		AddSaturated(nextTurnEnemyShipsTakingDamage[cell], direction);
+	});
+}
+
+void Map::PrepareNextTurn(const std::vector<SolidPlanet>& planets, const std::vector<DockedStamp>& dockedEnemies)
+{
+	ClearMap();
+	for (const SolidPlanet& planet : planets)
+		MarkSolid(planet.location, planet.radius);
+	for (const DockedStamp& stamp : dockedEnemies)
+		StampDocked(stamp, 1);
+
+	preparedPlanets = planets;
+	preparedStamps = dockedEnemies;
+	preparedDefinition = definition;
+	prepared = true;
+}
+
+void Map::RebuildMap()
+{
+	const bool reuse = prepared && preparedDefinition == definition && CurrentPlanets() == preparedPlanets;
+	prepared = false;
+
+	if (!reuse) {
+		ClearMap();
+		FillMap();
+		return;
+	}
+
+	// the docked ships that are still there keep their stamp
+	std::unordered_set<EntityId> stamped;
+	for (const DockedStamp& stamp : preparedStamps) {
+		Ship* ship = instance->GetShip(stamp.id);
+		if (ship && ship->owner_id == stamp.owner && ship->docking_status == ShipDockingStatus::Docked && ship->location == stamp.location)
+			stamped.insert(stamp.id);
+		else
+			StampDocked(stamp, -1);
+	}
+
+	FillShips(&stamped);
+}
+
+void Map::FillShips(const std::unordered_set<EntityId>* stamped)
+{
+	if (spawnCandidates.empty())
+		BuildSpawnCandidates();
+
+	// mark the ships that will spawn next turn
+	std::vector<GhostStamp> ghosts;
+	bool bucketed = false;
 	for (auto&kv : instance->planets) {
 		Planet* planet = kv.second;
 
-		IterateMap(planet->location, planet->radius + hlt::constants::SHIP_RADIUS, [&](Vector2 position, MapCell& cell, double distance) {
-			cell.solid = true;
-		});
-
 		int docked_ships = 0;
 		for (Ship* ship : planet->docked_ships) {
 			if (ship->docking_status == ShipDockingStatus::Docked)
@@ -35,75 +156,49 @@ void Map::FillMap()
 		}
 		const double production = static_cast<int>(docked_ships * hlt::constants::BASE_PRODUCTIVITY);
 
-		//Log::log() << "Planet: " << planet->entity_id << " Current Production: " << planet->current_production << " Production: " << production << std::endl;
-
-		if (planet->current_production + production >= hlt::constants::PRODUCTION_PER_SHIP) {
-			Vector2 best_location = { -1,-1 };
-			double best_distance = INF;
-			const auto& center = Vector2{ instance->map_width / 2.0, instance->map_height / 2.0 };
-
-			const auto max_delta = hlt::constants::SPAWN_RADIUS;
-			const auto open_radius = hlt::constants::SHIP_RADIUS * 3;
-			for (int dx = -max_delta; dx <= max_delta; dx++) {
-				for (int dy = -max_delta; dy <= max_delta; dy++) {
-					double offset_angle = std::atan2(dy, dx);
-					double offset_x = dx + planet->radius * std::cos(offset_angle);
-					double offset_y = dy + planet->radius * std::sin(offset_angle);
-					Vector2 location = planet->location + Vector2{ offset_x, offset_y };
-
-					if (location.x < 0 || location.y < 0 || location.x >= instance->map_width || location.y >= instance->map_height)
-						continue;
-
-					const auto distance = location.DistanceTo(center);
-
-					auto has_occupants = false;
-					for (auto&kv : instance->ships) {
-						Ship* ship = kv.second;
-						if (location.DistanceTo2(ship->location) <= std::pow(open_radius + ship->radius, 2)) {
-							has_occupants = true;
-							break;
-						}
-					}
+		//instance->logger.log() << "Planet: " << planet->entity_id << " Current Production: " << planet->current_production << " Production: " << production << std::endl;
 
-					if (distance < best_distance && !has_occupants) {
-						best_distance = distance;
-						best_location = location;
-					}
-				}
+		if (planet->current_production + production >= hlt::constants::PRODUCTION_PER_SHIP && planet->entity_id < spawnCandidates.size()) {
+			if (!bucketed) {
+				BucketShips();
+				bucketed = true;
 			}
 
-			if (best_location.x != -1) {
-				Log::log() << "A ship will spawn next turn in " << best_location << " by the planet " << planet->entity_id << std::endl;
-				Ship* ghostShip = new Ship(-1);
-				ghostShip->owner_id = planet->owner_id;
-				ghostShip->location = best_location;
-				ghostShip->frozen = true;
-				ghostShip->docking_status = ShipDockingStatus::Undocked;
-				ModifyShip(ghostShip);
-				delete ghostShip;
+			for (const Vector2& location : spawnCandidates[planet->entity_id]) {
+				if (!IsOccupied(location, hlt::constants::SHIP_RADIUS * 3)) {
+					instance->logger.log() << "A ship will spawn next turn in " << location << " by the planet " << planet->entity_id << std::endl;
+					ghosts.push_back({ planet->owner_id, location });
+					break;
+				}
 			}
 		}
 	}
 
 	// mark ships
+	std::vector<Ship*> toStamp;
 	for (auto&kv : instance->ships) {
 		Ship* ship = kv.second;
-		ModifyShip(ship);
+		if (stamped && stamped->count(ship->entity_id))
+			continue;
+		toStamp.push_back(ship);
 	}
+	StampShips(toStamp, ghosts);
 
 	/*
 	Image::WriteImage(std::string("turns/turn_") + std::to_string(instance->turn) + "_map.bmp", MAP_WIDTH, MAP_HEIGHT, [&](int x, int y) -> std::tuple<unsigned char, unsigned char, unsigned char> {
 		y = MAP_HEIGHT - y - 1;
 
-		if (cells[y][x].ship)
+		const int cell = y * MAP_WIDTH + x;
+
+		if (shipCells.Get(cell))
 			return std::make_tuple(0, 0, 255);
 
-		if (cells[y][x].solid)
+		if (solidCells.Get(cell))
 			return std::make_tuple(0, 0, 0);
 
-		int d1 = 200 - cells[y][x].nextTurnEnemyShipsAttackInRange * 15;
+		int d1 = 200 - nextTurnEnemyShipsAttackInRange[cell] * 15;
 		auto enemyColor = std::make_tuple(255, d1, d1);
-		int d2 = 200 - cells[y][x].nextTurnFriendlyShipsAttackInRange * 15;
+		int d2 = 200 - nextTurnFriendlyShipsAttackInRange[cell] * 15;
 		auto friendColor = std::make_tuple(d2, 255, d2);
 
 		if (d1 == 200 && d2 == 200)
@@ -118,10 +213,97 @@ void Map::FillMap()
 	*/
 }
 
-void Map::ModifyShip(Ship* ship, int direction)
+void Map::BuildSpawnCandidates()
+{
+	const Vector2 center = { instance->map_width / 2.0, instance->map_height / 2.0 };
+
+	for (auto&kv : instance->planets) {
+		Planet* planet = kv.second;
+		if (planet->entity_id >= spawnCandidates.size())
+			spawnCandidates.resize(planet->entity_id + 1);
+
+		std::vector<Vector2>& candidates = spawnCandidates[planet->entity_id];
+		const int max_delta = hlt::constants::SPAWN_RADIUS;
+		for (int dx = -max_delta; dx <= max_delta; dx++) {
+			for (int dy = -max_delta; dy <= max_delta; dy++) {
+				double offset_angle = std::atan2(dy, dx);
+				double offset_x = dx + planet->radius * std::cos(offset_angle);
+				double offset_y = dy + planet->radius * std::sin(offset_angle);
+				Vector2 location = planet->location + Vector2{ offset_x, offset_y };
+
+				if (location.x < 0 || location.y < 0 || location.x >= instance->map_width || location.y >= instance->map_height)
+					continue;
+				candidates.push_back(location);
+			}
+		}
+
+		// the engine keeps the first closest one
+		std::stable_sort(candidates.begin(), candidates.end(), [&](const Vector2& a, const Vector2& b) {
+			return a.DistanceTo(center) < b.DistanceTo(center);
+		});
+	}
+}
+
+void Map::BucketShips()
+{
+	occupancyColumns = std::max(1, (int)std::ceil(instance->map_width / SPAWN_CELL_SIZE));
+	occupancyRows = std::max(1, (int)std::ceil(instance->map_height / SPAWN_CELL_SIZE));
+	auto cellOf = [&](const Vector2& location) {
+		const int x = std::max(0, std::min(occupancyColumns - 1, (int)std::floor(location.x / SPAWN_CELL_SIZE)));
+		const int y = std::max(0, std::min(occupancyRows - 1, (int)std::floor(location.y / SPAWN_CELL_SIZE)));
+		return y * occupancyColumns + x;
+	};
+
+	// counting sort by cell
+	occupancyStart.assign(occupancyColumns * occupancyRows + 1, 0);
+	for (auto&kv : instance->ships)
+		occupancyStart[cellOf(kv.second->location) + 1]++;
+	for (int cell = 0; cell < occupancyColumns * occupancyRows; cell++)
+		occupancyStart[cell + 1] += occupancyStart[cell];
+
+	occupancyShips.resize(instance->ships.size());
+	std::vector<int> filled(occupancyStart.begin(), occupancyStart.end() - 1);
+	for (auto&kv : instance->ships)
+		occupancyShips[filled[cellOf(kv.second->location)]++] = kv.second;
+}
+
+bool Map::IsOccupied(const Vector2& location, double radius)
+{
+	// the ships are never bigger than SHIP_RADIUS, the ones clamped to the border cells are in range too
+	const double reach = radius + hlt::constants::SHIP_RADIUS;
+	const int x0 = std::max(0, (int)std::floor((location.x - reach) / SPAWN_CELL_SIZE)), x1 = std::min(occupancyColumns - 1, (int)std::floor((location.x + reach) / SPAWN_CELL_SIZE));
+	const int y0 = std::max(0, (int)std::floor((location.y - reach) / SPAWN_CELL_SIZE)), y1 = std::min(occupancyRows - 1, (int)std::floor((location.y + reach) / SPAWN_CELL_SIZE));
+
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			const int cell = y * occupancyColumns + x;
+			for (int i = occupancyStart[cell]; i < occupancyStart[cell + 1]; i++) {
+				Ship* ship = occupancyShips[i];
+				if (location.DistanceTo2(ship->location) <= std::pow(radius + ship->radius, 2))
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+void Map::ModifyShip(Ship* ship, int direction, StampLayer* layer)
 {
-	Instance* instance = Instance::Get();
+	ModifyShipRows(ship, direction, 0, MAP_HEIGHT, layer);
+}
 
+void Map::ApplyLayer(const StampLayer& layer)
+{
+	for (const StampLayer::Change& change : layer.changes) {
+		AddSaturated(nextTurnEnemyShipsTakingDamage[change.cell], change.counters[0]);
+		AddSaturated(nextTurnFriendlyShipsTakingDamage[change.cell], change.counters[1]);
+		AddSaturated(nextTurnEnemyShipsAttackInRange[change.cell], change.counters[2]);
+		AddSaturated(nextTurnFriendlyShipsAttackInRange[change.cell], change.counters[3]);
+	}
+}
+
+void Map::ModifyShipRows(Ship* ship, int direction, int rowBegin, int rowEnd, StampLayer* layer)
+{
 	bool is_docking = false;
 	double radius;
 
@@ -139,76 +321,366 @@ void Map::ModifyShip(Ship* ship, int direction)
 			radius = hlt::constants::SHIP_RADIUS + hlt::constants::WEAPON_RADIUS;
 	}
 
-	const double thrust_distance[8] = { // thrust 0-7
-		0,
-		sqrt(2 * (1 * 1)),
-		sqrt(2 * (2 * 2)),
-		sqrt(2 * (3 * 3)),
-		sqrt(2 * (4 * 4)),
-		sqrt(2 * (5 * 5)),
-		sqrt(2 * (6 * 6)),
-		sqrt(2 * (7 * 7)),
+	// our ships that move reach further in the directions they can thrust more
+	const bool moving = ship->IsOur() && !ship->frozen && !is_docking && ship->IsCommandable();
+	double attack_range[360];
+	bool use_table = false;
+	const Vector2 origin = ship->location - radius;
+
+	if (moving) {
+		for (int angle = 0; angle < 360; angle++)
+			attack_range[angle] = hlt::constants::SHIP_RADIUS + Tables::thrusts.diagonal[ship->max_thrusts[angle]] + hlt::constants::WEAPON_RADIUS;
+
+		// the angles are in the table unless the border moved the positions
+		Vector2 startPoint, endPoint;
+		IterationBounds(ship->location, radius, startPoint, endPoint);
+		use_table = startPoint.x == origin.x && startPoint.y == origin.y;
+		if (use_table && (angleTableRadius != radius || angleTableDefinition != definition)) {
+			// the bands and the workers with a layer run at the same time, only the whole map can build it
+			if (rowBegin == 0 && rowEnd == MAP_HEIGHT && layer == nullptr)
+				BuildAngleTable(radius);
+			else
+				use_table = false;
+		}
+	}
+
+	// the counter of the layers of the map (in their order) or of the layer
+	auto add = [&](MapCounter* counters, int counter, int cell) {
+		if (layer)
+			layer->Counters(cell)[counter] += direction;
+		else
+			AddSaturated(counters[cell], direction);
 	};
 
-	IterateMap(ship->location, radius, [&](Vector2 position, MapCell& cell, double distance) {
-		if (distance < hlt::constants::SHIP_RADIUS)
-			cell.ship = true;
+	IterateMap(ship->location, radius, [&](Vector2 position, int cell, double distance) {
+		if (distance < hlt::constants::SHIP_RADIUS && layer == nullptr)
+			shipCells.Set(cell);
 
 		if (ship->IsOur()) {
 			if (ship->frozen || is_docking) {
 				if (distance < hlt::constants::SHIP_RADIUS + hlt::constants::WEAPON_RADIUS)
-					cell.nextTurnFriendlyShipsTakingDamage += direction;
+					add(nextTurnFriendlyShipsTakingDamage, 1, cell);
 			}
 			else {
-				cell.nextTurnFriendlyShipsTakingDamage += direction;
+				add(nextTurnFriendlyShipsTakingDamage, 1, cell);
 				if (ship->IsCommandable()) {
-					int angle_deg = radToDegClipped(ship->location.OrientTowardsRad(position));
-					if (distance < hlt::constants::SHIP_RADIUS + thrust_distance[ship->max_thrusts[angle_deg]] + hlt::constants::WEAPON_RADIUS) {
-						cell.nextTurnFriendlyShipsAttackInRange += direction;
+					int angle_deg;
+					if (use_table) {
+						const int i = lround((position.x - origin.x) * definition);
+						const int j = lround((position.y - origin.y) * definition);
+						angle_deg = angleTable[i * angleTableSide + j];
+					}
+					else {
+						angle_deg = radToDegClipped(ship->location.OrientTowardsRad(position));
+					}
+					if (distance < attack_range[angle_deg]) {
+						add(nextTurnFriendlyShipsAttackInRange, 3, cell);
 					}
 				}
 			}
 		}
 		else {
-			cell.nextTurnEnemyShipsTakingDamage += direction;
+			add(nextTurnEnemyShipsTakingDamage, 0, cell);
 			if (ship->IsCommandable())
-				cell.nextTurnEnemyShipsAttackInRange += direction;
+				add(nextTurnEnemyShipsAttackInRange, 2, cell);
+		}
+	}, rowBegin, rowEnd);
+}
+
+void Map::ModifyGhostRows(const GhostStamp& ghost, int rowBegin, int rowEnd)
+{
+	const bool our = ghost.owner == instance->player_id;
+	const double radius = our ? hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED : hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED + hlt::constants::WEAPON_RADIUS + 1;
+
+	IterateMap(ghost.location, radius, [&](Vector2 position, int cell, double distance) {
+		if (distance < hlt::constants::SHIP_RADIUS)
+			shipCells.Set(cell);
+
+		if (our) {
+			if (distance < hlt::constants::SHIP_RADIUS + hlt::constants::WEAPON_RADIUS)
+				AddSaturated(nextTurnFriendlyShipsTakingDamage[cell], 1);
 		}
+		else {
+			AddSaturated(nextTurnEnemyShipsTakingDamage[cell], 1);
+			AddSaturated(nextTurnEnemyShipsAttackInRange[cell], 1);
+		}
+	}, rowBegin, rowEnd);
+}
+
+void Map::StampShips(const std::vector<Ship*>& ships, const std::vector<GhostStamp>& ghosts)
+{
+	stampSpans.clear();
+	std::vector<GhostStamp> otherGhosts;
+	for (const GhostStamp& ghost : ghosts) {
+		if (!AddGhostSpans(ghost))
+			otherGhosts.push_back(ghost);
+	}
+	std::vector<Ship*> others;
+	for (Ship* ship : ships) {
+		if (!AddShipSpans(ship))
+			others.push_back(ship);
+	}
+
+	if (!stampSpans.empty() && stampDiff.empty())
+		stampDiff.resize((MAP_HEIGHT + 1) * MAP_WIDTH * STAMP_CHANNELS, 0);
+
+	// the bands can't build it
+	const double radius = hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED;
+	if (angleTableRadius != radius || angleTableDefinition != definition)
+		BuildAngleTable(radius);
+
+	ForEachBand(FillThreads(ships.size()), [&](int rowBegin, int rowEnd) {
+		for (const GhostStamp& ghost : otherGhosts)
+			ModifyGhostRows(ghost, rowBegin, rowEnd);
+		for (Ship* ship : others)
+			ModifyShipRows(ship, 1, rowBegin, rowEnd);
+		ApplySpans(rowBegin, rowEnd);
 	});
 }
 
-MapCell& Map::GetCell(const Vector2& location)
+bool Map::AddShipSpans(Ship* ship)
 {
-	int x = location.x * MAP_DEFINITION;
-	int y = location.y * MAP_DEFINITION;
-	return cells[y][x];
+	// like ModifyShip
+	double radius, damage;
+	StampChannel damageChannel;
+	bool attack = false;
+
+	if (ship->IsOur()) {
+		bool is_docking = ship->task_id != -1 && instance->GetTask(ship->task_id)->type == TaskType::DOCK;
+		// the attack range of the ships that move depends on the angle
+		if (!ship->frozen && !is_docking)
+			return false;
+
+		radius = ship->radius + hlt::constants::MAX_SPEED;
+		damage = hlt::constants::SHIP_RADIUS + hlt::constants::WEAPON_RADIUS;
+		damageChannel = STAMP_FRIENDLY_DAMAGE;
+	}
+	else {
+		if (ship->IsCommandable())
+			radius = hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED + hlt::constants::WEAPON_RADIUS + 1;
+		else
+			radius = hlt::constants::SHIP_RADIUS + hlt::constants::WEAPON_RADIUS;
+		damage = radius;
+		damageChannel = STAMP_ENEMY_DAMAGE;
+		attack = ship->IsCommandable();
+	}
+
+	return AddStampSpans(ship->location, radius, damage, damageChannel, attack);
 }
 
-void Map::IterateMap(Vector2 location, double radius, std::function<void(Vector2, MapCell&, double)> action) {
-	if (!action) return;
+bool Map::AddGhostSpans(const GhostStamp& ghost)
+{
+	if (ghost.owner == instance->player_id)
+		return AddStampSpans(ghost.location, hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED, hlt::constants::SHIP_RADIUS + hlt::constants::WEAPON_RADIUS, STAMP_FRIENDLY_DAMAGE, false);
 
-	Instance* instance = Instance::Get();
+	const double radius = hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED + hlt::constants::WEAPON_RADIUS + 1;
+	return AddStampSpans(ghost.location, radius, radius, STAMP_ENEMY_DAMAGE, true);
+}
 
-	Vector2 startPoint = location - radius;
-	Vector2 endPoint = location + radius;
+bool Map::AddStampSpans(const Vector2& location, double radius, double damage, StampChannel damageChannel, bool attack)
+{
+	// the same positions that IterateMap visits
+	Vector2 startPoint, endPoint;
+	IterationBounds(location, radius, startPoint, endPoint);
+
+	const double step = 1.0 / definition;
+	stampXs.clear();
+	stampYs.clear();
+	for (double ix = startPoint.x; ix <= endPoint.x; ix += step)
+		stampXs.push_back(ix);
+	for (double iy = startPoint.y; iy <= endPoint.y; iy += step)
+		stampYs.push_back(iy);
+
+	// a column is a span only if every position falls in the next cell
+	if (stampXs.empty() || stampYs.empty())
+		return true;
+	const int firstY = (int)(stampYs[0] * definition);
+	for (int k = 1; k < stampYs.size(); k++) {
+		if ((int)(stampYs[k] * definition) != firstY + k)
+			return false;
+	}
 
-	const double borderSeparation = 1;
+	AddDiscSpans(location, std::min(damage, radius), damageChannel);
+	if (attack)
+		AddDiscSpans(location, radius, STAMP_ENEMY_ATTACK);
+	AddDiscSpans(location, std::min((double)hlt::constants::SHIP_RADIUS, radius), STAMP_SHIP);
+	return true;
+}
 
-	startPoint.x = std::fmin(std::fmax(startPoint.x, borderSeparation), instance->map_width - borderSeparation);
-	startPoint.y = std::fmin(std::fmax(startPoint.y, borderSeparation), instance->map_height - borderSeparation);
+void Map::AddDiscSpans(const Vector2& location, double inner, StampChannel channel)
+{
+	const double step = 1.0 / definition;
+	const int count = stampYs.size();
+
+	for (double ix : stampXs) {
+		const double dx = ix - location.x;
+		if (std::abs(dx) > inner + 1e-9) continue;
+
+		auto inside = [&](int k) {
+			return location.DistanceTo({ ix, stampYs[k] }) < inner;
+		};
+
+		// the exact ends are searched around the analytic ones, the positions in between are inside
+		const double half = sqrt(std::max(0.0, inner * inner - dx * dx));
+		int low = std::max(0, (int)std::floor((location.y - half - stampYs[0]) / step) - 2);
+		int high = std::min(count - 1, (int)std::ceil((location.y + half - stampYs[0]) / step) + 2);
+		while (low <= high && !inside(low))
+			low++;
+		if (low > high) continue;
+		while (!inside(high))
+			high--;
+
+		stampSpans.push_back({ (short)(int)(ix * definition), (short)(int)(stampYs[low] * definition), (short)(int)(stampYs[high] * definition), (unsigned char)channel });
+	}
+}
 
-	endPoint.x = std::fmin(std::fmax(endPoint.x, borderSeparation), instance->map_width - borderSeparation);
-	endPoint.y = std::fmin(std::fmax(endPoint.y, borderSeparation), instance->map_height - borderSeparation);
+void Map::ApplySpans(int rowBegin, int rowEnd)
+{
+	// the spans clipped to the rows, the tiles down to the one that cancels every span
+	bool tiles[STAMP_TILES_Y][STAMP_TILES_X] = {};
+	int stamped = 0, touched = 0;
+	for (const StampSpan& span : stampSpans) {
+		const int y0 = std::max((int)span.y0, rowBegin), y1 = std::min((int)span.y1, rowEnd - 1);
+		if (y0 > y1) continue;
+		stamped += y1 - y0 + 1;
+		for (int ty = y0 / STAMP_TILE; ty <= std::min(y1 + 1, rowEnd - 1) / STAMP_TILE; ty++) {
+			touched += !tiles[ty][span.x / STAMP_TILE];
+			tiles[ty][span.x / STAMP_TILE] = true;
+		}
+	}
+
+	// the ships barely overlap, summing the tiles would cost more than writing the spans
+	if (stamped < touched * STAMP_TILE * STAMP_TILE) {
+		for (const StampSpan& span : stampSpans) {
+			const int y0 = std::max((int)span.y0, rowBegin), y1 = std::min((int)span.y1, rowEnd - 1);
+			const int first = y0 * MAP_WIDTH + span.x, last = y1 * MAP_WIDTH + span.x;
+			switch (span.channel) {
+			case STAMP_SHIP:
+				for (int cell = first; cell <= last; cell += MAP_WIDTH) shipCells.Set(cell);
+				break;
+			case STAMP_ENEMY_DAMAGE:
+				for (int cell = first; cell <= last; cell += MAP_WIDTH) AddSaturated(nextTurnEnemyShipsTakingDamage[cell], 1);
+				break;
+			case STAMP_ENEMY_ATTACK:
+				for (int cell = first; cell <= last; cell += MAP_WIDTH) AddSaturated(nextTurnEnemyShipsAttackInRange[cell], 1);
+				break;
+			case STAMP_FRIENDLY_DAMAGE:
+				for (int cell = first; cell <= last; cell += MAP_WIDTH) AddSaturated(nextTurnFriendlyShipsTakingDamage[cell], 1);
+				break;
+			}
+		}
+		return;
+	}
 
-	const double step = 1.0 / MAP_DEFINITION;
+	// only the rows of the band are written, a span clipped at the end doesn't need the cancel
+	for (const StampSpan& span : stampSpans) {
+		const int y0 = std::max((int)span.y0, rowBegin), y1 = std::min((int)span.y1, rowEnd - 1);
+		if (y0 > y1) continue;
+		stampDiff[(y0 * MAP_WIDTH + span.x) * STAMP_CHANNELS + span.channel]++;
+		if (y1 + 1 < rowEnd)
+			stampDiff[((y1 + 1) * MAP_WIDTH + span.x) * STAMP_CHANNELS + span.channel]--;
+	}
 
-	for (double ix = startPoint.x; ix <= endPoint.x; ix += step) {
-		for (double iy = startPoint.y; iy <= endPoint.y; iy += step) {
-			Vector2 position = { (double)ix, (double)iy };
-			double d = location.DistanceTo(position);
-			if (d < radius) {
-				action(position, GetCell(position), d);
+	// prefix sums down the columns of every column of tiles, the difference array is left zeroed
+	// (the sums are zero again before a tile without spans)
+	for (int tx = 0; tx < STAMP_TILES_X; tx++) {
+		int sums[STAMP_TILE][STAMP_CHANNELS] = {};
+
+		for (int ty = rowBegin / STAMP_TILE; ty * STAMP_TILE < rowEnd; ty++) {
+			if (!tiles[ty][tx]) continue;
+
+			const int endY = std::min((ty + 1) * STAMP_TILE, rowEnd);
+			for (int y = std::max(ty * STAMP_TILE, rowBegin); y < endY; y++) {
+				short* diff = &stampDiff[(y * MAP_WIDTH + tx * STAMP_TILE) * STAMP_CHANNELS];
+				for (int x = 0; x < STAMP_TILE; x++) {
+					for (int c = 0; c < STAMP_CHANNELS; c++) {
+						sums[x][c] += diff[x * STAMP_CHANNELS + c];
+						diff[x * STAMP_CHANNELS + c] = 0;
+					}
+				}
+
+				const int row = y * MAP_WIDTH + tx * STAMP_TILE;
+				for (int x = 0; x < STAMP_TILE; x++) {
+					if (sums[x][STAMP_SHIP] > 0)
+						shipCells.Set(row + x);
+					AddSaturated(nextTurnEnemyShipsTakingDamage[row + x], sums[x][STAMP_ENEMY_DAMAGE]);
+					AddSaturated(nextTurnEnemyShipsAttackInRange[row + x], sums[x][STAMP_ENEMY_ATTACK]);
+					AddSaturated(nextTurnFriendlyShipsTakingDamage[row + x], sums[x][STAMP_FRIENDLY_DAMAGE]);
+				}
 			}
 		}
 	}
 }
+
+template<typename Work>
+void Map::ForEachBand(int threads, Work work)
+{
+	const int rows = std::min(MAP_HEIGHT, (int)instance->map_height * definition + 1);
+	threads = std::max(1, std::min(threads, rows / STAMP_TILE));
+	if (threads == 1) {
+		work(0, MAP_HEIGHT);
+		return;
+	}
+
+	// the bands start at a tile, the last one takes the rest of the rows
+	const int band = (rows / threads + STAMP_TILE - 1) / STAMP_TILE * STAMP_TILE;
+	std::vector<std::thread> workers;
+	for (int t = 1; t < threads; t++) {
+		const int rowBegin = t * band, rowEnd = t == threads - 1 ? MAP_HEIGHT : (t + 1) * band;
+		if (rowBegin < rowEnd)
+			workers.emplace_back([=]() { work(rowBegin, rowEnd); });
+	}
+	work(0, band);
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+int Map::FillThreads(int ships)
+{
+	return std::min((int)std::thread::hardware_concurrency(), 1 + ships / MAP_FILL_SHIPS_PER_THREAD);
+}
+
+void Map::BuildAngleTable(double radius)
+{
+	const double step = 1.0 / definition;
+	angleTableSide = (int)(2 * radius * definition) + 2;
+	angleTable.resize(angleTableSide * angleTableSide);
+
+	for (int i = 0; i < angleTableSide; i++) {
+		for (int j = 0; j < angleTableSide; j++) {
+			const Vector2 offset = { -radius + i * step, -radius + j * step };
+			angleTable[i * angleTableSide + j] = radToDegClipped(Vector2{ 0, 0 }.OrientTowardsRad(offset));
+		}
+	}
+	angleTableRadius = radius;
+	angleTableDefinition = definition;
+}
+
+void Map::BuildSolidTable()
+{
+	solidTableDefinition = definition;
+	solidTableColumns = std::min(MAP_WIDTH, (int)instance->map_width * definition + 1);
+	solidTableRows = std::min(MAP_HEIGHT, (int)instance->map_height * definition + 1);
+	solidTable.assign((solidTableRows + 1) * (solidTableColumns + 1), 0);
+
+	const int stride = solidTableColumns + 1;
+	for (int y = 0; y < solidTableRows; y++) {
+		int row = 0;
+		for (int x = 0; x < solidTableColumns; x++) {
+			row += solidCells.Get(y * MAP_WIDTH + x);
+			solidTable[(y + 1) * stride + x + 1] = solidTable[y * stride + x + 1] + row;
+		}
+	}
+}
+
+bool Map::IsAreaFree(const Vector2& from, const Vector2& to) const
+{
+	// the cells of the positions, clipped to the table
+	const int x0 = std::max(0, (int)(from.x * solidTableDefinition)), y0 = std::max(0, (int)(from.y * solidTableDefinition));
+	const int x1 = std::min(solidTableColumns - 1, (int)(to.x * solidTableDefinition)), y1 = std::min(solidTableRows - 1, (int)(to.y * solidTableDefinition));
+	if (x0 > x1 || y0 > y1)
+		return true;
+
+	const int stride = solidTableColumns + 1;
+	return solidTable[(y1 + 1) * stride + x1 + 1] - solidTable[y0 * stride + x1 + 1] - solidTable[(y1 + 1) * stride + x0] + solidTable[y0 * stride + x0] == 0;
+}
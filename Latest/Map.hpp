@@ -1,40 +1,246 @@
 #pragma once
 
-#include <functional>
-
 #include "Vector2.hpp"
 #include "Ship.hpp"
 
+class Instance;
+
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
 #define MAP_MAX_WIDTH 384
 #define MAP_MAX_HEIGHT 256
-#define MAP_DEFINITION 4
+#define MAP_DEFINITION 4 // the finest, the layers are allocated for it
 #define MAP_WIDTH MAP_MAX_WIDTH * MAP_DEFINITION
 #define MAP_HEIGHT MAP_MAX_HEIGHT * MAP_DEFINITION
+#define MAP_CELLS (MAP_WIDTH * MAP_HEIGHT)
+
+// the definitions (cells per unit) the map can run at, the finest first
+const int MAP_DEFINITIONS[] = { MAP_DEFINITION, MAP_DEFINITION / 2, MAP_DEFINITION / 4 };
+const int MAP_DEFINITION_LEVELS = 3;
+
+// size of the cells of the ship buckets for the occupancy of the spawns
+const double SPAWN_CELL_SIZE = 8;
+
+// below this many ships per thread filling the map in bands costs more than it saves
+const int MAP_FILL_SHIPS_PER_THREAD = 32;
+
+// cells per side of the tiles of Map::StampShips, only the tiles with spans are summed
+#define STAMP_TILE 16
+#define STAMP_TILES_X (MAP_WIDTH / STAMP_TILE)
+#define STAMP_TILES_Y (MAP_HEIGHT / STAMP_TILE + 1)
+
+// a counter of the map, they saturate instead of wrapping
+// (signed: unstamping a ship whose max thrusts changed can leave negative attack ranges)
+typedef int16_t MapCounter;
+const int MAP_COUNTER_MAX = 32767;
+
+inline void AddSaturated(MapCounter& counter, int amount) {
+	counter = (MapCounter)std::max(-MAP_COUNTER_MAX, std::min(MAP_COUNTER_MAX, counter + amount));
+}
+
+/* One bit per cell of the map */
+class MapBits {
+public:
+	bool Get(int cell) const { return (words[cell >> 6] >> (cell & 63)) & 1; }
+	void Set(int cell) { words[cell >> 6] |= (uint64_t)1 << (cell & 63); }
+	void Reset(int cell) { words[cell >> 6] &= ~((uint64_t)1 << (cell & 63)); }
+	void Clear() { memset(words, 0, sizeof(words)); }
+
+private:
+	uint64_t words[MAP_CELLS / 64];
+};
+
+// what the speculative worker needs to prepare the next map (see Map::PrepareNextTurn)
+struct SolidPlanet {
+	EntityId id;
+	Vector2 location;
+	double radius;
+
+	bool operator==(const SolidPlanet& other) const {
+		return id == other.id && location == other.location && radius == other.radius;
+	}
+};
+struct DockedStamp {
+	EntityId id;
+	PlayerId owner;
+	Vector2 location;
+};
+// a ship that will spawn next turn, stamped like a frozen ship without a Ship object
+struct GhostStamp {
+	PlayerId owner;
+	Vector2 location;
+};
 
-struct MapCell {
-	bool ship = false;
-	bool solid = false;
+/*
+	Changes to the counters of the map kept apart from the layers, so a worker can stamp
+	the ships of its component and read the map through them while the other workers read
+	the map. Map::ApplyLayer adds them to the map on the main thread when the workers are done
+	(the components are far apart, the layers of two workers never share a cell).
+*/
+class StampLayer {
+public:
+	// the changes of the counters of the cell in the order of the layers of the map, nullptr if none
+	const int* Find(int cell) const {
+		auto it = index.find(cell);
+		return it == index.end() ? nullptr : changes[it->second].counters;
+	}
+	int* Counters(int cell) {
+		auto it = index.emplace(cell, (int)changes.size());
+		if (it.second)
+			changes.push_back({ cell, { 0, 0, 0, 0 } });
+		return changes[it.first->second].counters;
+	}
 
-	int nextTurnEnemyShipsTakingDamage = 0; // indefense and non indefense ships
-	int nextTurnFriendlyShipsTakingDamage = 0; // indefense and non indefense ships
+	struct Change {
+		int cell;
+		int counters[4];
+	};
+	std::vector<Change> changes;
 
-	int nextTurnEnemyShipsAttackInRange = 0; // non indefense ships in range
-	int nextTurnFriendlyShipsAttackInRange = 0; // firendly ships within range
+private:
+	std::unordered_map<int, int> index; // cell -> changes
 };
 
 /* The navigation map */
 class Map {
 public:
-	Map();
+	Map(Instance* instance);
 
 	void ClearMap();
 	void FillMap();
-	void ModifyShip(Ship* ship, int direction = 1);
+	// into the layer instead of the map if there is one (the ship cells don't change)
+	void ModifyShip(Ship* ship, int direction = 1, StampLayer* layer = nullptr);
+	void ApplyLayer(const StampLayer& layer);
+	// ModifyShip(ship) for many ships at once: the stamps that are discs (the enemies and our
+	// ships that don't move) are written as vertical spans of cells into a difference array and
+	// summed in one pass over the tiles they touch, the rest use ModifyShip (the result is the same)
+	// the map is split in bands of rows stamped by different threads
+	void StampShips(const std::vector<Ship*>& ships, const std::vector<GhostStamp>& ghosts = std::vector<GhostStamp>());
+
+	// runs in the speculative worker while we wait for the next frame: clears the map, marks
+	// the planets and stamps the enemy docked ships (they don't move)
+	void PrepareNextTurn(const std::vector<SolidPlanet>& planets, const std::vector<DockedStamp>& dockedEnemies);
+	// ClearMap + FillMap, reusing what PrepareNextTurn did if the planets are the same,
+	// the docked ships that changed are unstamped (the result is the same)
+	void RebuildMap();
+	// alive planets, sorted by id
+	std::vector<SolidPlanet> CurrentPlanets();
+
+	// summed-area table of solidCells for IsAreaFree, it's a copy of the solids of the moment
+	// (the planets only change when they die, build it again if it matters)
+	void BuildSolidTable();
+	// no solid cell between the positions from and to (inclusive), in O(1)
+	bool IsAreaFree(const Vector2& from, const Vector2& to) const;
+
+	// index of the cell in the layers
+	int CellIndex(const Vector2& location) const {
+		int x = location.x * definition;
+		int y = location.y * definition;
+		return y * MAP_WIDTH + x;
+	}
+
+	// action(Vector2 position, int cell, double distance) for every cell inside the circle
+	// (only the ones in the rows [rowBegin, rowEnd) of the layers)
+	// it's a template (defined in Map.cpp) so the lambdas get inlined and no std::function is allocated
+	template<typename Action>
+	void IterateMap(Vector2 location, double radius, Action action, int rowBegin = 0, int rowEnd = MAP_HEIGHT);
+
+private:
+	// the area of the cells that IterateMap visits
+	void IterationBounds(const Vector2& location, double radius, Vector2& startPoint, Vector2& endPoint);
+
+	enum StampChannel {
+		STAMP_SHIP,
+		STAMP_ENEMY_DAMAGE,
+		STAMP_ENEMY_ATTACK,
+		STAMP_FRIENDLY_DAMAGE,
+		STAMP_CHANNELS
+	};
+	// cells [y0, y1] of the column x
+	struct StampSpan {
+		short x, y0, y1;
+		unsigned char channel;
+	};
+	// false if the ship can't be stamped with spans
+	bool AddShipSpans(Ship* ship);
+	bool AddGhostSpans(const GhostStamp& ghost);
+	// the discs of a ship that doesn't move: every cell of the iteration, the damage closer than
+	// damage and the attack range of the enemies in all of them
+	bool AddStampSpans(const Vector2& location, double radius, double damage, StampChannel damageChannel, bool attack);
+	// the cells of IterateMap closer than inner to the location (inner <= the radius of the iteration)
+	void AddDiscSpans(const Vector2& location, double inner, StampChannel channel);
+	void ApplySpans(int rowBegin, int rowEnd);
+
+	// work(rowBegin, rowEnd) for bands of rows of the map on different threads, the bands don't share
+	// words of the bitsets (a row is a multiple of 64 cells)
+	template<typename Work>
+	void ForEachBand(int threads, Work work);
+	int FillThreads(int ships);
+	void ModifyShipRows(Ship* ship, int direction, int rowBegin, int rowEnd, StampLayer* layer = nullptr);
+	// ModifyShipRows of a frozen ship (ours) or an undocked one (enemy)
+	void ModifyGhostRows(const GhostStamp& ghost, int rowBegin, int rowEnd);
+
+	// radToDegClipped of the direction from the center of IterateMap(location, radius) to every
+	// position it visits, they are always at the same offsets unless the border clips the area
+	void BuildAngleTable(double radius);
+
+	void MarkSolid(const Vector2& location, double radius, int rowBegin = 0, int rowEnd = MAP_HEIGHT);
+	void StampDocked(const DockedStamp& stamp, int direction);
+	// the ships that will spawn next turn and our ships, except the ones in stamped
+	void FillShips(const std::unordered_set<EntityId>* stamped);
+	// the planets don't move: where their ships can spawn, the engine picks the first free one
+	void BuildSpawnCandidates();
+	void BucketShips();
+	// a ship closer than radius + its radius to the location
+	bool IsOccupied(const Vector2& location, double radius);
+
+public:
+	Instance* instance;
+
+	// cells per unit of the layers (the rows are always MAP_WIDTH apart), one of MAP_DEFINITIONS
+	// the next RebuildMap uses it, a coarse map is much faster to fill
+	int definition = MAP_DEFINITION;
+
+	// prepared by the speculative worker
+	bool prepared = false;
+	int preparedDefinition;
+	std::vector<SolidPlanet> preparedPlanets;
+	std::vector<DockedStamp> preparedStamps;
+
+	// FillShips, by planet id, sorted by the distance to the center of the map
+	std::vector<std::vector<Vector2>> spawnCandidates;
+	// FillShips, the ships bucketed in cells of SPAWN_CELL_SIZE ([occupancyStart[cell], occupancyStart[cell + 1]))
+	std::vector<int> occupancyStart;
+	std::vector<Ship*> occupancyShips;
+	int occupancyColumns = 0, occupancyRows = 0;
+
+	// (rows + 1) x (columns + 1), solid cells above and to the left
+	std::vector<int> solidTable;
+	int solidTableColumns = 0, solidTableRows = 0, solidTableDefinition = MAP_DEFINITION;
 
-	MapCell& GetCell(const Vector2& location);
-	void IterateMap(Vector2 location, double radius, std::function<void(Vector2, MapCell&, double)> action);
+	// ModifyShip, [i * angleTableSide + j] for the position i steps right and j down of the corner
+	std::vector<short> angleTable;
+	int angleTableSide = 0;
+	double angleTableRadius = -1;
+	int angleTableDefinition = 0;
 
+	// StampShips
+	std::vector<StampSpan> stampSpans;
+	std::vector<double> stampXs, stampYs; // positions of the iteration
+	// (MAP_HEIGHT + 1) x MAP_WIDTH x channels, zero between uses
+	std::vector<short> stampDiff;
 
-	// -
-	MapCell cells[MAP_HEIGHT][MAP_WIDTH];
+	// the layers, indexed by CellIndex (every channel is separate so the scoring only
+	// touches the ones it reads)
+	MapBits solidCells; // planets
+	MapBits shipCells;
+	MapCounter nextTurnEnemyShipsTakingDamage[MAP_CELLS]; // indefense and non indefense ships
+	MapCounter nextTurnFriendlyShipsTakingDamage[MAP_CELLS]; // indefense and non indefense ships
+	MapCounter nextTurnEnemyShipsAttackInRange[MAP_CELLS]; // non indefense ships in range
+	MapCounter nextTurnFriendlyShipsAttackInRange[MAP_CELLS]; // firendly ships within range
 };
\ No newline at end of file
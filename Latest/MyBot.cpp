@@ -4,9 +4,13 @@
 // mlomb-bot
 /////////////////////////////////////////////
 
-int main() {
+int main(int argc, char** argv) {
 	Instance* instance = new Instance();
 
+	// MyBot.exe --record game.rec
+	if (argc > 2 && std::string(argv[1]) == "--record")
+		instance->Record(argv[2]);
+
 	instance->Initialize("mlomb-bot-v41");
 	instance->Play();
 
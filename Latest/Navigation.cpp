@@ -1,16 +1,23 @@
 #include "Navigation.hpp"
 
-#include <deque>
 #include <queue>
 #include <unordered_set>
+#include <unordered_map>
 #include <algorithm>
+#include <thread>
+#include <atomic>
 
 #include "Instance.hpp"
 #include "Log.hpp"
 #include "Image.hpp"
+#include "Skirmish.hpp"
 
 const double angular_step_rad = M_PI / 180.0; // 1 degree
 
+// requests further than this can't affect each other while picking options:
+// the map stamp of a frozen ship + the furthest scored position + some room for the cells
+const double COMPONENT_RADIUS = (hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED) + (hlt::constants::MAX_SPEED + 3) + 1;
+
 double random(int min, int max) {
 	static bool first = true;
 	if (first)
@@ -28,9 +35,7 @@ bool Navigation::CheckEntityBetween(const Vector2& start, const Vector2& target,
 	return false;
 }
 
-bool Navigation::AreObjectsBetween(const Vector2& start, const Vector2& target) {
-	Instance* instance = Instance::Get();
-
+bool Navigation::AreObjectsBetween(Instance* instance, const Vector2& start, const Vector2& target) {
 	for (auto& kv : instance->planets) {
 		if (CheckEntityBetween(start, target, kv.second))
 			return true;
@@ -46,27 +51,35 @@ bool Navigation::AreObjectsBetween(const Vector2& start, const Vector2& target)
 	return false;
 }
 
-bool Navigation::IsOutsideTheMap(const Vector2& location)
+bool Navigation::IsOutsideTheMap(Instance* instance, const Vector2& location)
 {
-	Instance* instance = Instance::Get();
 	return location.x <= 0 || location.y <= 0 || location.x >= instance->map_width - 1 || location.y >= instance->map_height - 1;
 }
 
-double Navigation::GetPositionScore(const Vector2& position, const Vector2& targetLocation, bool avoiding_enemies)
+double Navigation::GetPositionScore(Instance* instance, const Vector2& position, const Vector2& targetLocation, bool avoiding_enemies, const StampLayer* layer)
 {
-	Map* map = Instance::Get()->map;
+	Map* map = instance->map;
 
-	if (Navigation::IsOutsideTheMap(position)) {
+	if (Navigation::IsOutsideTheMap(instance, position)) {
 		return -99;
 	}
 	else {
-		MapCell& cell = map->GetCell(position);
+		const int cell = map->CellIndex(position);
+		int enemyShipsTakingDamage = map->nextTurnEnemyShipsTakingDamage[cell];
+		int friendlyShipsTakingDamage = map->nextTurnFriendlyShipsTakingDamage[cell];
+		int enemyShipsAttackInRange = map->nextTurnEnemyShipsAttackInRange[cell];
+		if (const int* changes = layer ? layer->Find(cell) : nullptr) {
+			enemyShipsTakingDamage += changes[0];
+			friendlyShipsTakingDamage += changes[1];
+			enemyShipsAttackInRange += changes[2];
+		}
+
 		if (avoiding_enemies) {
-			return (100 - cell.nextTurnEnemyShipsAttackInRange) * 10000 + MAX_DISTANCE - position.DistanceTo(targetLocation);
+			return (100 - enemyShipsAttackInRange) * 10000 + MAX_DISTANCE - position.DistanceTo(targetLocation);
 		}
 		else {
-			if (cell.nextTurnFriendlyShipsTakingDamage > cell.nextTurnEnemyShipsAttackInRange) {
-				return cell.nextTurnEnemyShipsTakingDamage * 10000 + MAX_DISTANCE - position.DistanceTo(targetLocation);
+			if (friendlyShipsTakingDamage > enemyShipsAttackInRange) {
+				return enemyShipsTakingDamage * 10000 + MAX_DISTANCE - position.DistanceTo(targetLocation);
 			}
 			else {
 				return -99;
@@ -75,11 +88,7 @@ double Navigation::GetPositionScore(const Vector2& position, const Vector2& targ
 	}
 }
 
-const int MAX_TIME = 1850;
-
-void CalculateScores(std::set<NavigationRequest*>& navigationRequests) {
-	Instance* instance = Instance::Get();
-
+void CalculateScores(Instance* instance, NavigationRequestSet& navigationRequests, const StampLayer* layer = nullptr) {
 	for (NavigationRequest* navReq : navigationRequests) {
 		Ship* ship = navReq->ship;
 		
@@ -94,7 +103,7 @@ void CalculateScores(std::set<NavigationRequest*>& navigationRequests) {
 				double bestScore = -INF;
 				for (int t_off = 0; t_off < (option.future ? 4 : 1); t_off++) {
 					Vector2 position = ship->location + instance->velocityCache[option.angle][option.thrust + t_off];
-					double score = Navigation::GetPositionScore(position, navReq->targetLocation, navReq->avoid_enemies);
+					double score = Navigation::GetPositionScore(instance, position, navReq->targetLocation, navReq->avoid_enemies, layer);
 					if (score > bestScore) {
 						bestScore = score;
 					}
@@ -103,8 +112,11 @@ void CalculateScores(std::set<NavigationRequest*>& navigationRequests) {
 					}
 				}
 				option.score = bestScore;
+
+				if (option.angle == navReq->preferred_angle && option.thrust == navReq->preferred_thrust)
+					option.score = PREFERRED_OPTION_SCORE;
 			}
-			//Log::log() << "Ship " << ship->entity_id << " angle: " << option.angle << " thrust: " << option.thrust << " max_thrust: " << max_thrusts[option.angle] << " future: " << option.future << " score: " << option.score << std::endl;
+			//instance->logger.log() << "Ship " << ship->entity_id << " angle: " << option.angle << " thrust: " << option.thrust << " max_thrust: " << max_thrusts[option.angle] << " future: " << option.future << " score: " << option.score << std::endl;
 		}
 
 		std::sort(ship->navigationOptions.begin(), ship->navigationOptions.end());
@@ -112,14 +124,14 @@ void CalculateScores(std::set<NavigationRequest*>& navigationRequests) {
 	}
 }
 
-std::vector<Move> GenerateMoves(std::set<NavigationRequest*>& navigationRequests) {
+std::vector<Move> GenerateMoves(Instance* instance, NavigationRequestSet& navigationRequests) {
 	std::vector<Move> moves;
 
 	moves.reserve(navigationRequests.size());
 	for (NavigationRequest* navReq : navigationRequests) {
 		Ship* ship = navReq->ship;
 
-		Log::log() << "Ship " << ship->entity_id << ": " << ship->optionSelected << std::endl;
+		instance->logger.log() << "Ship " << ship->entity_id << ": " << ship->optionSelected << std::endl;
 
 		if (ship->optionSelected == -1)
 			continue;
@@ -132,151 +144,339 @@ std::vector<Move> GenerateMoves(std::set<NavigationRequest*>& navigationRequests
 	return moves;
 }
 
-std::vector<Move> Navigation::NavigateShips(std::set<NavigationRequest*> navigationRequests)
+// picks the options of a group of requests that can't interact with the rest of the requests
+// q starts with all the requests of the group, it never grows beyond that so it never allocates
+// the frozen ships are stamped in the layer of the group, the workers never write the map
+// returns false if we ran out of time
+bool PickOptions(Instance* instance, NavigationRequestSet& navigationRequests, ArenaVector<NavigationRequest*>& q, StampLayer& layer, std::atomic<bool>& timeout) {
+	Map* map = instance->map;
+
+	while (!q.empty()) {
+		if (timeout || instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
+			return false;
+
+		std::sort(q.begin(), q.end(), [](const NavigationRequest* a, const NavigationRequest* b) {
+			if (a->ship->task_priority == b->ship->task_priority)
+				return a->ship->entity_id < b->ship->entity_id;
+			return a->ship->task_priority < b->ship->task_priority;
+		});
+
+		NavigationRequest* navReq = q.front();
+		Ship* ship = navReq->ship;
+		q.erase(q.begin());
+
+		for (ship->optionSelected = 0; ship->optionSelected < ship->navigationOptions.size(); ship->optionSelected++) {
+			const NavigationOption& option = ship->navigationOptions[ship->optionSelected];
+			const Vector2& velocity = instance->velocityCache[option.angle][option.thrust];
+			const Vector2 futurePosition = ship->location + velocity;
+
+			bool conflict = Navigation::IsOutsideTheMap(instance, futurePosition);
+			conflict |= option.score <= -99;
+
+			if (!conflict) {
+				for (NavigationRequest* navReqOther : navigationRequests) {
+					if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
+						return false;
+
+					if (navReq == navReqOther) continue;
+
+					Ship* shipOther = navReqOther->ship;
+					const NavigationOption& otherOption = shipOther->navigationOptions[shipOther->optionSelected];
+
+					const double r = hlt::constants::SHIP_RADIUS * 2;
+					auto t = Navigation::collision_time(r, ship->location, shipOther->location, velocity, instance->velocityCache[otherOption.angle][otherOption.thrust]);
+					if (t.first && t.second >= 0 && t.second <= 1) { // collision
+						conflict = true;
+						break;
+					}
+				}
+			}
+
+			if (!conflict)
+				break; // yay!
+		}
+
+		if (ship->optionSelected > ship->navigationOptions.size() - 1) {
+			// If the conflict couldnt be resolved, this ship will stand still
+
+			if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
+				return false;
+
+			ship->optionSelected = -1;
+			
+			// remove the ship
+			map->ModifyShip(navReq->ship, -1, &layer);
+
+			navReq->ship->frozen = true;
+
+			// remove this navigation request
+			navigationRequests.erase(navReq);
+			for (NavigationRequest* navReqOther : navReq->eventHorizon) {
+				navReqOther->eventHorizon.erase(navReq);
+				navReqOther->ship->collisionEventHorizon.push_back(navReq->ship);
+				navReqOther->ship->UpdateMaxThrusts();
+				navReqOther->ship->optionSelected = 0;
+				
+				if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
+					return false;
+			}
+
+			// add the frozen ship
+			map->ModifyShip(navReq->ship, 1, &layer);
+
+			// update the affected ships
+			CalculateScores(instance, navReq->eventHorizon, &layer);
+
+			if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
+				return false;
+
+			for (NavigationRequest* navReqOther : navReq->eventHorizon) {
+				auto it = std::find(q.begin(), q.end(), navReqOther);
+				if (it == q.end())
+					q.insert(q.begin(), navReqOther);
+			}
+			//instance->logger.log() << "Ship " << navReq->ship->entity_id << " couldn't solve the conflicts." << std::endl;
+		}
+		else {
+			//instance->logger.log() << "Ship " << navReq->ship->entity_id << " picked option " << navReq->ship->optionSelected << std::endl;
+		}
+	}
+
+	return true;
+}
+
+int FindComponent(ArenaVector<int>& parent, int i) {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+std::vector<Move> Navigation::NavigateShips(Instance* instance, NavigationRequestSet& navigationRequests)
 {
-	Stopwatch s("Navigate " + std::to_string(navigationRequests.size()) + " ships");
-	Log::log() << "Navigating " << navigationRequests.size() << " ships." << std::endl;
+	Stopwatch s(instance, "Navigate " + std::to_string(navigationRequests.size()) + " ships");
+	instance->logger.log() << "Navigating " << navigationRequests.size() << " ships." << std::endl;
 
-	Instance* instance = Instance::Get();
 	Map* map = instance->map;
-		
+	Arena* arena = &instance->arena;
+
+	// sorted by id, so the results don't depend on the memory layout
+	ArenaVector<NavigationRequest*> requests(navigationRequests.begin(), navigationRequests.end(), arena);
+	std::sort(requests.begin(), requests.end(), [](const NavigationRequest* a, const NavigationRequest* b) {
+		return a->ship->entity_id < b->ship->entity_id;
+	});
+
+	// requests that are not transitively connected are solved independently
+	ArenaVector<int> parent(requests.size(), 0, arena);
+	for (int i = 0; i < requests.size(); i++)
+		parent[i] = i;
+
 	{
-		Stopwatch s("Filling event horizons");
-		for (auto it1 = navigationRequests.begin(); it1 != navigationRequests.end(); it1++) {
-			NavigationRequest* navReqA = *it1;
+		Stopwatch s(instance, "Filling event horizons");
+		for (int i = 0; i < requests.size(); i++) {
+			NavigationRequest* navReqA = requests[i];
 
-			for (auto it2 = std::next(it1); it2 != navigationRequests.end(); it2++) {
-				NavigationRequest* navReqB = *it2;
+			for (int j = i + 1; j < requests.size(); j++) {
+				NavigationRequest* navReqB = requests[j];
 
-				if (navReqA->ship->location.DistanceTo(navReqB->ship->location) < (hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED) * 2 + hlt::constants::SHIP_RADIUS) {
+				double distance = navReqA->ship->location.DistanceTo(navReqB->ship->location);
+				if (distance < EVENT_HORIZON_RADIUS) {
 					navReqA->eventHorizon.insert(navReqB);
 					navReqB->eventHorizon.insert(navReqA);
 				}
+				if (distance < COMPONENT_RADIUS) {
+					parent[FindComponent(parent, i)] = FindComponent(parent, j);
+				}
 			}
 
 			Ship* ship = navReqA->ship;
-			ship->collisionEventHorizon.clear();
-			ship->collisionEventHorizon = instance->GetEntitiesInside(ship, hlt::constants::MAX_SPEED);
+			instance->GetEntitiesInside(ship, hlt::constants::MAX_SPEED, ship->collisionEventHorizon);
 		}
 	}
 
 	{
-		Stopwatch s("Calculating max thrusts");
+		Stopwatch s(instance, "Calculating max thrusts");
 		for (NavigationRequest* navReq : navigationRequests) {
 			navReq->ship->UpdateMaxThrusts();
 		}
 	}
 
 	{
-		Stopwatch s("Clear and fill the map");
-		map->ClearMap();
-		map->FillMap();
+		Stopwatch s(instance, "Clear and fill the map");
+		auto fill_start = std::chrono::high_resolution_clock::now();
+		map->RebuildMap();
+		std::chrono::duration<double, std::milli> fill_elapsed = std::chrono::high_resolution_clock::now() - fill_start;
+		instance->admission.ObserveFixed(fill_elapsed.count());
 	}
 
 	{
-		Stopwatch s("Calculating scores 1st time");
-		CalculateScores(navigationRequests);
+		Stopwatch s(instance, "Calculating scores 1st time");
+		CalculateScores(instance, navigationRequests);
 	}
 
 	// pick options
 	{
-		Stopwatch s("Picking options");
-		std::deque<NavigationRequest*> q;
-		for (NavigationRequest* navReq : navigationRequests) {
-			q.push_front(navReq);
+		// everything the workers need is allocated here, the arena is not thread safe
+		ArenaVector<ArenaVector<NavigationRequest*>> components(arena);
+		{
+			ArenaVector<int> componentIndex(requests.size(), -1, arena);
+			for (int i = 0; i < requests.size(); i++) {
+				int root = FindComponent(parent, i);
+				if (componentIndex[root] == -1) {
+					componentIndex[root] = components.size();
+					components.emplace_back(arena);
+				}
+				components[componentIndex[root]].push_back(requests[i]);
+			}
 		}
+		// the big ones first, so the threads end at the same time
+		std::stable_sort(components.begin(), components.end(), [](const ArenaVector<NavigationRequest*>& a, const ArenaVector<NavigationRequest*>& b) {
+			return a.size() > b.size();
+		});
+
+		// the best joint moves of the fights become the preferred options
+		Skirmish::SearchAll(instance, components);
+
+		ArenaVector<NavigationRequestSet> componentRequests(arena);
+		componentRequests.reserve(components.size());
+		for (const ArenaVector<NavigationRequest*>& component : components)
+			componentRequests.emplace_back(component.begin(), component.end(), arena);
+
+		int threads = std::max(1, std::min((int)std::thread::hardware_concurrency(), (int)components.size()));
+		Stopwatch s(instance, "Picking options (" + std::to_string(components.size()) + " components, " + std::to_string(threads) + " threads)");
+
+		std::atomic<bool> timeout(false);
+		std::atomic<int> next_component(0);
+		std::vector<StampLayer> layers(components.size());
+
+		auto worker = [&]() {
+			int c;
+			while ((c = next_component++) < components.size()) {
+				if (!PickOptions(instance, componentRequests[c], components[c], layers[c], timeout))
+					timeout = true;
+			}
+		};
+
+		std::vector<std::thread> workers;
+		for (int i = 1; i < threads; i++)
+			workers.emplace_back(worker);
+		worker();
+		for (std::thread& t : workers)
+			t.join();
+
+		// the frozen ships
+		for (const StampLayer& layer : layers)
+			map->ApplyLayer(layer);
+	}
 
-		while (!q.empty()) {
-			if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
-				return GenerateMoves(navigationRequests);
+	return GenerateMoves(instance, navigationRequests);
+}
 
-			std::sort(q.begin(), q.end(), [](const NavigationRequest* a, const NavigationRequest* b) {
-				return a->ship->task_priority < b->ship->task_priority;
-			});
+std::vector<Move> Navigation::NavigateFallback(Instance* instance, const ArenaVector<NavigationRequest*>& navigationRequests, const std::vector<Move>& committedMoves)
+{
+	std::vector<Move> moves;
+	if (navigationRequests.empty())
+		return moves;
 
-			NavigationRequest* navReq = q.front();
-			Ship* ship = navReq->ship;
-			q.pop_front();
+	Stopwatch s(instance, "Fallback navigate " + std::to_string(navigationRequests.size()) + " ships");
 
-			for (ship->optionSelected = 0; ship->optionSelected < ship->navigationOptions.size(); ship->optionSelected++) {
-				const NavigationOption& option = ship->navigationOptions[ship->optionSelected];
-				const Vector2& velocity = instance->velocityCache[option.angle][option.thrust];
-				const Vector2 futurePosition = ship->location + velocity;
+	Arena* arena = &instance->arena;
 
-				bool conflict = Navigation::IsOutsideTheMap(futurePosition);
-				conflict |= option.score <= -99;
+	struct Reservation {
+		Vector2 location;
+		Vector2 velocity;
+	};
 
-				if (!conflict) {
-					for (NavigationRequest* navReqOther : navigationRequests) {
-						if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
-							return GenerateMoves(navigationRequests);
+	// every ship stays where it is, except the ones already navigated
+	ArenaVector<Reservation> reservations(arena);
+	std::unordered_map<EntityId, int, std::hash<EntityId>, std::equal_to<EntityId>, ArenaAllocator<std::pair<const EntityId, int>>> reservationIndex(instance->ships.size(), std::hash<EntityId>(), std::equal_to<EntityId>(), arena);
+	reservations.reserve(instance->ships.size());
+	for (auto& kv : instance->ships) {
+		reservationIndex[kv.first] = reservations.size();
+		reservations.push_back({ kv.second->location, { 0, 0 } });
+	}
+	for (const Move& move : committedMoves) {
+		if (move.type == MoveType::Thrust)
+			reservations[reservationIndex[move.ship_id]].velocity = instance->velocityCache[move.move_angle_deg][move.move_thrust];
+	}
 
-						if (navReq == navReqOther) continue;
+	// the reservations start where the ships are, so a grid of the ships finds the close ones
+	DensityGrid everyone;
+	everyone.Clear(instance->map_width, instance->map_height);
+	for (auto& kv : instance->ships)
+		everyone.Add(kv.second);
 
-						Ship* shipOther = navReqOther->ship;
-						const NavigationOption& otherOption = shipOther->navigationOptions[shipOther->optionSelected];
+	std::vector<Ship*> nearShips;
+	ArenaVector<Planet*> nearPlanets(arena);
+	Map* map = instance->map;
 
-						const double r = hlt::constants::SHIP_RADIUS * 2;
-						auto t = Navigation::collision_time(r, ship->location, shipOther->location, velocity, instance->velocityCache[otherOption.angle][otherOption.thrust]);
-						if (t.first && t.second >= 0 && t.second <= 1) { // collision
-							conflict = true;
-							break;
-						}
-					}
-				}
+	for (NavigationRequest* navReq : navigationRequests) {
+		if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
+			break;
+
+		Ship* ship = navReq->ship;
+		const int selfIndex = reservationIndex[ship->entity_id];
+
+		const double distance = ship->location.DistanceTo(navReq->targetLocation);
+		const int thrust = std::min(hlt::constants::MAX_SPEED, (int)distance);
+		if (thrust == 0)
+			continue;
 
-				if (!conflict)
-					break; // yay!
+		// only the close entities can get in the way
+		everyone.Find(ship->location, EVENT_HORIZON_RADIUS, nearShips);
+		nearPlanets.clear();
+		if (navReq->avoid_obstacles) {
+			for (auto& kv : instance->planets) {
+				if (ship->IsClose(kv.second, thrust + hlt::constants::FORECAST_FUDGE_FACTOR))
+					nearPlanets.push_back(kv.second);
 			}
+		}
 
-			if (ship->optionSelected > ship->navigationOptions.size() - 1) {
-				// If the conflict couldnt be resolved, this ship will stand still
+		const int targetAngle = radToDegClipped(ship->location.OrientTowardsRad(navReq->targetLocation));
 
-				if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
-					return GenerateMoves(navigationRequests);
+		// avoiding the enemies the first angle out of their range wins, or the one in range of
+		// the fewest of them if it isn't worse than staying (like GetPositionScore)
+		int angle = -1, bestAttacks = navReq->avoid_enemies ? map->nextTurnEnemyShipsAttackInRange[map->CellIndex(ship->location)] + 1 : 0;
 
-				ship->optionSelected = -1;
-				
-				// remove the ship
-				map->ModifyShip(navReq->ship, -1);
-
-				navReq->ship->frozen = true;
-
-				// remove this navigation request
-				navigationRequests.erase(navReq);
-				for (NavigationRequest* navReqOther : navReq->eventHorizon) {
-					navReqOther->eventHorizon.erase(navReq);
-					navReqOther->ship->collisionEventHorizon.push_back(navReq->ship);
-					navReqOther->ship->UpdateMaxThrusts();
-					navReqOther->ship->optionSelected = 0;
-					
-					if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
-						return GenerateMoves(navigationRequests);
-				}
+		for (int correction = 0; correction <= hlt::constants::MAX_NAVIGATION_CORRECTIONS && (angle == -1 || bestAttacks > 0); correction++) {
+			for (int side = 0; side < (correction == 0 ? 1 : 2); side++) {
+				const int candidate = (targetAngle + (side == 0 ? correction : -correction) + 360) % 360;
+				const Vector2& velocity = instance->velocityCache[candidate][thrust];
+				const Vector2 futurePosition = ship->location + velocity;
 
-				// add the frozen ship
-				map->ModifyShip(navReq->ship);
+				bool conflict = Navigation::IsOutsideTheMap(instance, futurePosition);
 
-				// update the affected ships
-				CalculateScores(navReq->eventHorizon);
+				const int attacks = conflict || !navReq->avoid_enemies ? 0 : map->nextTurnEnemyShipsAttackInRange[map->CellIndex(futurePosition)];
+				conflict = conflict || (navReq->avoid_enemies && attacks >= bestAttacks);
 
-				if (instance->CurrentTurnTime() > MAX_TIME) // prevent timeout
-					return GenerateMoves(navigationRequests);
+				for (int i = 0; !conflict && i < nearPlanets.size(); i++)
+					conflict = CheckEntityBetween(ship->location, futurePosition, nearPlanets[i]);
 
-				for (NavigationRequest* navReqOther : navReq->eventHorizon) {
-					auto it = std::find(q.begin(), q.end(), navReqOther);
-					if (it == q.end())
-						q.push_front(navReqOther);
+				for (int i = 0; !conflict && i < nearShips.size(); i++) {
+					if (nearShips[i] == ship) continue;
+					const Reservation& other = reservations[reservationIndex[nearShips[i]->entity_id]];
+					auto t = Navigation::collision_time(hlt::constants::SHIP_RADIUS * 2, ship->location, other.location, velocity, other.velocity);
+					conflict = t.first && t.second >= 0 && t.second <= 1;
+				}
+
+				if (!conflict) {
+					angle = candidate;
+					bestAttacks = attacks;
+					break;
 				}
-				//Log::log() << "Ship " << navReq->ship->entity_id << " couldn't solve the conflicts." << std::endl;
-			}
-			else {
-				//Log::log() << "Ship " << navReq->ship->entity_id << " picked option " << navReq->ship->optionSelected << std::endl;
 			}
 		}
+
+		if (angle != -1) {
+			reservations[selfIndex].velocity = instance->velocityCache[angle][thrust];
+			moves.push_back(Move::thrust(ship->entity_id, thrust, angle));
+		}
 	}
 
-	return GenerateMoves(navigationRequests);
+	instance->logger.log() << "Fallback navigation moved " << moves.size() << " of " << navigationRequests.size() << " ships" << std::endl;
+
+	return moves;
 }
 
 
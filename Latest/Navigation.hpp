@@ -9,9 +9,26 @@
 #include "Move.hpp"
 #include "Vector2.hpp"
 #include "Entity.hpp"
+#include "Arena.hpp"
 
 class Ship;
-class NavigationRequest;
+class Instance;
+class StampLayer;
+struct NavigationRequest;
+
+typedef ArenaSet<NavigationRequest*> NavigationRequestSet;
+
+// ms, after this we stop navigating to prevent timeouts
+const int MAX_TIME = 1850;
+
+// ships closer than this may collide this turn
+const double EVENT_HORIZON_RADIUS = (hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED) * 2 + hlt::constants::SHIP_RADIUS;
+
+// enemy ships closer than this may shoot us next turn
+const double COMBAT_RANGE = hlt::constants::MAX_SPEED * 2 + hlt::constants::WEAPON_RADIUS + hlt::constants::SHIP_RADIUS;
+
+// the score of the preferred option of a request, above any position score
+const double PREFERRED_OPTION_SCORE = INF;
 
 class NavigationOption {
 public:
@@ -31,15 +48,20 @@ public:
 
 struct NavigationRequest {
 public:
-	NavigationRequest() { }
+	NavigationRequest(Arena* arena) : eventHorizon(ArenaAllocator<NavigationRequest*>(arena)) { }
 
 	Ship* ship;
 	
 	Vector2 targetLocation;
 	bool avoid_enemies;
 	bool avoid_obstacles = true;
+	bool near_combat = false;
+
+	// the move picked by the skirmish search (-1 = none)
+	int preferred_angle = -1;
+	int preferred_thrust = -1;
 
-	std::set<NavigationRequest*> eventHorizon;
+	NavigationRequestSet eventHorizon;
 };
 
 class Navigation {
@@ -49,12 +71,15 @@ public:
 	static std::pair<bool, double> collision_time(long double r, const Vector2& loc1, const Vector2& loc2, const Vector2& vel1, const Vector2& vel2);
 
 	static bool CheckEntityBetween(const Vector2& start, const Vector2& target, const Entity* entity_to_check);
-	static bool AreObjectsBetween(const Vector2& start, const Vector2& target);
-	static bool IsOutsideTheMap(const Vector2& location);
+	static bool AreObjectsBetween(Instance* instance, const Vector2& start, const Vector2& target);
+	static bool IsOutsideTheMap(Instance* instance, const Vector2& location);
 
-	static double GetPositionScore(const Vector2& position, const Vector2& targetLocation, bool avoiding_enemies);
+	// the map is read through the layer if there is one
+	static double GetPositionScore(Instance* instance, const Vector2& position, const Vector2& targetLocation, bool avoiding_enemies, const StampLayer* layer = nullptr);
 
-	static std::vector<Move> NavigateShips(std::set<NavigationRequest*> navigationRequests);
+	static std::vector<Move> NavigateShips(Instance* instance, NavigationRequestSet& navigationRequests);
+	// greedy straight line navigation (hlt style) avoiding planets and the moves already committed, it's very cheap
+	static std::vector<Move> NavigateFallback(Instance* instance, const ArenaVector<NavigationRequest*>& navigationRequests, const std::vector<Move>& committedMoves);
 private:
 	Navigation();
 };
\ No newline at end of file
@@ -2,6 +2,6 @@
 
 #include "Instance.hpp"
 
-Planet::Planet(EntityId id) : Entity(id)
+Planet::Planet(Instance* instance, EntityId id) : Entity(instance, id)
 {
 }
\ No newline at end of file
@@ -9,7 +9,7 @@ class Ship;
 
 class Planet : public Entity {
 public:
-	Planet(EntityId id);
+	Planet(Instance* instance, EntityId id);
 
 	int remaining_production;
 	int current_production;
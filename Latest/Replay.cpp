@@ -0,0 +1,164 @@
+#include "Instance.hpp"
+#include "Input.hpp"
+
+#include <map>
+#include <iomanip>
+#include <algorithm>
+
+/////////////////////////////////////////////
+// Replays a game recorded with
+//   MyBot.exe --record game.rec
+// without the engine and the opponents:
+//   Replay.exe game.rec [repetitions]
+// Every turn is run [repetitions] times (the moves of the first run are
+// compared with the recorded ones) and the timings are reported
+/////////////////////////////////////////////
+
+struct PhaseStats {
+	double total = 0; // ms
+	double max = 0; // ms
+	int count = 0;
+};
+
+// ship id -> move
+static std::map<std::string, std::string> SplitMoves(const std::string& line) {
+	std::map<std::string, std::string> moves;
+	std::istringstream iss(line);
+	std::string type, ship_id;
+
+	while (iss >> type >> ship_id) {
+		std::string move = type;
+		int args = type == "t" ? 2 : (type == "d" ? 1 : 0);
+		for (int i = 0; i < args; i++) {
+			std::string arg;
+			iss >> arg;
+			move += " " + arg;
+		}
+		moves[ship_id] = move;
+	}
+
+	return moves;
+}
+
+static int CountDifferentMoves(const std::string& a, const std::string& b) {
+	std::map<std::string, std::string> movesA = SplitMoves(a);
+	std::map<std::string, std::string> movesB = SplitMoves(b);
+
+	int different = 0;
+	for (auto& kv : movesA) {
+		auto it = movesB.find(kv.first);
+		if (it == movesB.end() || (*it).second != kv.second)
+			different++;
+	}
+	for (auto& kv : movesB) {
+		if (movesA.find(kv.first) == movesA.end())
+			different++;
+	}
+	return different;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cerr << "Usage: Replay.exe game.rec [repetitions]" << std::endl;
+		return 1;
+	}
+
+	std::ifstream file(argv[1]);
+	if (!file.is_open()) {
+		std::cerr << "Can't open " << argv[1] << std::endl;
+		return 1;
+	}
+	int repetitions = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1;
+
+	std::ostringstream discard; // the bot name
+
+	Instance* instance = new Instance();
+	instance->in_stream = &file;
+	instance->out_stream = &discard;
+	instance->Initialize("replay");
+	instance->FlushTimings();
+
+	std::map<std::string, PhaseStats> phases;
+	std::string input, recordedMoves;
+	int turns = 0, mismatchedTurns = 0;
+	double totalTime = 0, maxTime = 0;
+
+	while (true) {
+		in::GetString(input, file);
+		in::GetString(recordedMoves, file);
+		if (!file.good())
+			break; // end of the game (or the bot died in the middle of the turn)
+
+		unsigned int turn = instance->turn;
+		std::string moves;
+		double minTime = INF, sumTime = 0;
+
+		for (int r = 0; r < repetitions; r++) {
+			// the repetitions run over the same input, but the state carried
+			// between turns (task registry, admission model...) sees them as extra turns
+			instance->turn = turn;
+
+			auto start = std::chrono::high_resolution_clock::now();
+			instance->BeginTurn(input);
+			std::vector<Move> frameMoves = instance->Frame();
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+			if (r == 0)
+				moves = Instance::SerializeMoves(frameMoves);
+
+			for (auto& timing : instance->timings) {
+				PhaseStats& stats = phases[Stopwatch::PhaseName(timing.first)];
+				stats.total += timing.second;
+				stats.max = std::max(stats.max, timing.second);
+				stats.count++;
+			}
+			instance->FlushTimings();
+
+			minTime = std::min(minTime, elapsed.count());
+			sumTime += elapsed.count();
+		}
+
+		int different = CountDifferentMoves(moves, recordedMoves);
+		if (different > 0)
+			mismatchedTurns++;
+
+		turns++;
+		totalTime += sumTime / repetitions;
+		maxTime = std::max(maxTime, sumTime / repetitions);
+
+		std::cout << "Turn " << std::setw(3) << turn
+				  << " ships: " << std::setw(4) << instance->myShips.size()
+				  << std::fixed << std::setprecision(2)
+				  << " avg: " << std::setw(8) << sumTime / repetitions << "ms"
+				  << " min: " << std::setw(8) << minTime << "ms";
+		if (different > 0)
+			std::cout << " -- " << different << " moves differ";
+		std::cout << std::endl;
+	}
+
+	std::cout << std::endl
+			  << "Turns: " << turns << " total: " << totalTime << "ms"
+			  << " avg: " << (turns > 0 ? totalTime / turns : 0) << "ms max: " << maxTime << "ms" << std::endl
+			  << "Turns with different moves: " << mismatchedTurns
+			  << " (the navigation depends on the time left, it's not fully deterministic)" << std::endl << std::endl;
+
+	// slowest phases first
+	std::vector<std::pair<std::string, PhaseStats>> sortedPhases(phases.begin(), phases.end());
+	std::sort(sortedPhases.begin(), sortedPhases.end(), [](const std::pair<std::string, PhaseStats>& a, const std::pair<std::string, PhaseStats>& b) {
+		return a.second.total > b.second.total;
+	});
+
+	std::cout << std::left << std::setw(44) << "Phase" << std::right
+			  << std::setw(12) << "total ms" << std::setw(10) << "avg ms" << std::setw(10) << "max ms" << std::setw(8) << "calls" << std::endl;
+	for (auto& kv : sortedPhases) {
+		std::cout << std::left << std::setw(44) << kv.first << std::right
+				  << std::setw(12) << kv.second.total
+				  << std::setw(10) << kv.second.total / kv.second.count
+				  << std::setw(10) << kv.second.max
+				  << std::setw(8) << kv.second.count << std::endl;
+	}
+
+	delete instance;
+
+	return 0;
+}
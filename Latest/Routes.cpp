@@ -0,0 +1,170 @@
+#include "Routes.hpp"
+
+#include <algorithm>
+
+#include "Instance.hpp"
+
+Routes::Routes()
+{
+}
+
+void Routes::Build(Instance* instance)
+{
+	obstacles.clear();
+	nodes.clear();
+	nodeObstacle.clear();
+
+	for (auto& kv : instance->planets)
+		obstacles.push_back({ kv.second->location, kv.second->radius + hlt::constants::FORECAST_FUDGE_FACTOR });
+	// the order of the map doesn't depend on the ids
+	std::sort(obstacles.begin(), obstacles.end(), [](const Obstacle& a, const Obstacle& b) {
+		return a.location.x < b.location.x || (a.location.x == b.location.x && a.location.y < b.location.y);
+	});
+
+	// the sides of the polygon are ROUTE_MARGIN away from the obstacle
+	for (int o = 0; o < obstacles.size(); o++) {
+		const double ring = (obstacles[o].radius + ROUTE_MARGIN) / cos(M_PI / ROUTE_NODES_PER_PLANET);
+
+		for (int i = 0; i < ROUTE_NODES_PER_PLANET; i++) {
+			const double angle = 2 * M_PI * i / ROUTE_NODES_PER_PLANET;
+			const Vector2 node = { obstacles[o].location.x + ring * cos(angle), obstacles[o].location.y + ring * sin(angle) };
+
+			if (Navigation::IsOutsideTheMap(instance, node)) continue;
+			bool inside = false;
+			for (const Obstacle& obstacle : obstacles)
+				inside |= node.DistanceTo(obstacle.location) < obstacle.radius;
+			if (inside) continue;
+
+			nodes.push_back(node);
+			nodeObstacle.push_back(o);
+		}
+	}
+
+	const int n = nodes.size();
+	distances.assign(n * n, (float)INF);
+	next.assign(n * n, -1);
+
+	for (int i = 0; i < n; i++) {
+		distances[i * n + i] = 0;
+		next[i * n + i] = i;
+		for (int j = i + 1; j < n; j++) {
+			if (!IsVisible(nodes[i], nodes[j])) continue;
+			distances[i * n + j] = distances[j * n + i] = (float)nodes[i].DistanceTo(nodes[j]);
+			next[i * n + j] = j;
+			next[j * n + i] = i;
+		}
+	}
+
+	// Floyd-Warshall
+	for (int k = 0; k < n; k++) {
+		const float* fromK = &distances[k * n];
+		for (int i = 0; i < n; i++) {
+			const float toK = distances[i * n + k];
+			if (toK >= INF) continue;
+
+			float* fromI = &distances[i * n];
+			short* nextI = &next[i * n];
+			for (int j = 0; j < n; j++) {
+				if (toK + fromK[j] < fromI[j]) {
+					fromI[j] = toK + fromK[j];
+					nextI[j] = nextI[k];
+				}
+			}
+		}
+	}
+
+	instance->logger.log() << "Routes: " << n << " nodes" << std::endl;
+}
+
+bool Routes::IsVisible(const Vector2& a, const Vector2& b) const
+{
+	return FirstObstacle(a, b) == -1;
+}
+
+int Routes::FirstObstacle(const Vector2& a, const Vector2& b) const
+{
+	const Vector2 ab = b - a;
+	const double length2 = ab.x * ab.x + ab.y * ab.y;
+
+	int first = -1;
+	double firstT = INF;
+
+	for (int o = 0; o < obstacles.size(); o++) {
+		const Obstacle& obstacle = obstacles[o];
+		if (a.DistanceTo(obstacle.location) < obstacle.radius || b.DistanceTo(obstacle.location) < obstacle.radius)
+			continue;
+
+		// the point of the segment closest to the center
+		const Vector2 ac = obstacle.location - a;
+		const double t = length2 > 0 ? std::max(0.0, std::min(1.0, (ac.x * ab.x + ac.y * ab.y) / length2)) : 0;
+		if ((a + ab * t).DistanceTo(obstacle.location) < obstacle.radius && t < firstT) {
+			first = o;
+			firstT = t;
+		}
+	}
+
+	return first;
+}
+
+void Routes::VisibleNodes(const Vector2& location, int obstacle, std::vector<int>& found) const
+{
+	found.clear();
+	for (int i = 0; i < nodes.size(); i++) {
+		if (nodeObstacle[i] == obstacle && IsVisible(location, nodes[i]))
+			found.push_back(i);
+	}
+
+	if (found.empty()) {
+		for (int i = 0; i < nodes.size(); i++) {
+			if (IsVisible(location, nodes[i]))
+				found.push_back(i);
+		}
+	}
+}
+
+Vector2 Routes::NextWaypoint(const Vector2& from, const Vector2& target) const
+{
+	const int first = FirstObstacle(from, target);
+	if (first == -1)
+		return target;
+
+	std::vector<int> starts, ends;
+	VisibleNodes(from, first, starts);
+	VisibleNodes(target, FirstObstacle(target, from), ends);
+
+	const int n = nodes.size();
+	int bestStart = -1, bestEnd = -1;
+	double bestLength = INF;
+
+	for (int a : starts) {
+		const double toStart = from.DistanceTo(nodes[a]);
+		for (int b : ends) {
+			if (distances[a * n + b] >= INF) continue;
+			const double length = toStart + distances[a * n + b] + nodes[b].DistanceTo(target);
+			if (length < bestLength) {
+				bestLength = length;
+				bestStart = a;
+				bestEnd = b;
+			}
+		}
+	}
+
+	if (bestStart == -1)
+		return target;
+
+	// the furthest node of the path that we can see
+	int waypoint = bestStart;
+	while (waypoint != bestEnd) {
+		const int following = next[waypoint * n + bestEnd];
+		if (!IsVisible(from, nodes[following]))
+			break;
+		waypoint = following;
+	}
+
+	// a close waypoint would stop the ship, it keeps going past it (the line doesn't enter the polygon)
+	const double distance = from.DistanceTo(nodes[waypoint]);
+	if (distance < hlt::constants::MAX_SPEED && distance > 0)
+		return from + (nodes[waypoint] - from) * (hlt::constants::MAX_SPEED / distance);
+
+	return nodes[waypoint];
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "Vector2.hpp"
+
+class Instance;
+
+// nodes on the ring around every planet
+const int ROUTE_NODES_PER_PLANET = 16;
+// room between the ships and the planets (on top of FORECAST_FUDGE_FACTOR) along the routes
+const double ROUTE_MARGIN = 0.5;
+
+/*
+	Visibility graph of the planets to route the long trips around them.
+	Every planet gets a ring of nodes (a polygon whose sides clear the planet), the nodes that
+	see each other without crossing a planet are connected and the shortest paths between all
+	of them are computed once in Initialize (the planets don't move, a destroyed planet only
+	makes the routes a bit longer).
+	A query enters the graph through the nodes of the first planet in the way, leaves it through
+	the nodes of the last one and returns the furthest node of the path that can be seen,
+	so the ships cut the corners.
+*/
+class Routes {
+public:
+	Routes();
+
+	void Build(Instance* instance);
+
+	// where to head to reach the target without crossing a planet (the target if nothing is in the way)
+	Vector2 NextWaypoint(const Vector2& from, const Vector2& target) const;
+
+private:
+	struct Obstacle {
+		Vector2 location;
+		double radius;
+	};
+
+	// the segment doesn't cross any planet (the planets that contain an end are ignored)
+	bool IsVisible(const Vector2& a, const Vector2& b) const;
+	// the planet crossed by the segment closest to a or -1
+	int FirstObstacle(const Vector2& a, const Vector2& b) const;
+	// the nodes of the obstacle that can be seen from the location (all the nodes if none)
+	void VisibleNodes(const Vector2& location, int obstacle, std::vector<int>& found) const;
+
+	std::vector<Obstacle> obstacles;
+	std::vector<Vector2> nodes;
+	std::vector<int> nodeObstacle;
+	std::vector<float> distances; // nodes x nodes, INF if there is no path
+	std::vector<short> next; // nodes x nodes, the node after i in the path from i to j
+};
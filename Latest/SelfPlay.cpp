@@ -0,0 +1,454 @@
+#include "Simulator.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
+/////////////////////////////////////////////
+// Plays games with the native simulator (Simulator.hpp), no halite.exe needed:
+//   SelfPlay.exe [-g games] [-j threads] [-W width -H height] [-s seed] [-q] bot1 bot2 [bot3 bot4]
+// a bot is the command to run it (it talks over pipes like with the engine)
+// or "starter" for a simple bot that runs in-process
+// -q prints a line per game for scripts (see hlt_client/tournament.py):
+//   result width height seed turns seconds [rank avg_ms max_ms failed] (for every bot)
+// The bots are rotated between the seats every game.
+// Note that every MyBot.exe built with HALITE_LOCAL writes its own log
+/////////////////////////////////////////////
+
+// ms, like the engine
+const int INIT_TIMEOUT = 60000;
+const int TURN_TIMEOUT = 2000;
+
+class SimBot {
+public:
+	virtual ~SimBot() { }
+
+	// sends the lines to the bot (the init lines or a frame)
+	virtual bool Send(const std::string& lines) = 0;
+	// waits for its answer (the name or the moves)
+	virtual bool Receive(const Simulator& game, PlayerId player, std::string& line, int timeout_ms) = 0;
+};
+
+/* A bot in its own process, over pipes */
+class PipeBot : public SimBot {
+public:
+	PipeBot(const std::string& command) {
+#ifdef _WIN32
+		SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+		HANDLE childIn, childOut;
+		if (!CreatePipe(&childIn, &toChild, &sa, 0) || !CreatePipe(&fromChild, &childOut, &sa, 0))
+			return;
+		SetHandleInformation(toChild, HANDLE_FLAG_INHERIT, 0);
+		SetHandleInformation(fromChild, HANDLE_FLAG_INHERIT, 0);
+
+		STARTUPINFOA si = {};
+		si.cb = sizeof(si);
+		si.dwFlags = STARTF_USESTDHANDLES;
+		si.hStdInput = childIn;
+		si.hStdOutput = childOut;
+		si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+		std::string commandLine = command;
+		PROCESS_INFORMATION pi = {};
+		running = CreateProcessA(NULL, &commandLine[0], NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi) != 0;
+		CloseHandle(childIn);
+		CloseHandle(childOut);
+		if (running) {
+			process = pi.hProcess;
+			CloseHandle(pi.hThread);
+		}
+#else
+		int inPipe[2], outPipe[2];
+		if (pipe(inPipe) != 0 || pipe(outPipe) != 0)
+			return;
+		// the games fork at the same time, the other bots must not inherit these ends
+		// (a dead bot would never close its output), dup2 clears the flag of stdin/stdout
+		for (int fd : { inPipe[0], inPipe[1], outPipe[0], outPipe[1] })
+			fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+		pid = fork();
+		if (pid == 0) {
+			dup2(inPipe[0], STDIN_FILENO);
+			dup2(outPipe[1], STDOUT_FILENO);
+			close(inPipe[0]); close(inPipe[1]);
+			close(outPipe[0]); close(outPipe[1]);
+			execl("/bin/sh", "sh", "-c", ("exec " + command).c_str(), (char*)NULL);
+			_exit(127);
+		}
+
+		close(inPipe[0]);
+		close(outPipe[1]);
+		toChild = inPipe[1];
+		fromChild = outPipe[0];
+		running = pid > 0;
+#endif
+	}
+
+	~PipeBot() {
+#ifdef _WIN32
+		if (running) {
+			TerminateProcess(process, 0);
+			CloseHandle(process);
+		}
+		CloseHandle(toChild);
+		CloseHandle(fromChild);
+#else
+		if (running) {
+			kill(pid, SIGKILL);
+			waitpid(pid, NULL, 0);
+		}
+		close(toChild);
+		close(fromChild);
+#endif
+	}
+
+	bool Send(const std::string& lines) override {
+		if (!running) return false;
+
+		size_t written = 0;
+		while (written < lines.size()) {
+#ifdef _WIN32
+			DWORD n;
+			if (!WriteFile(toChild, lines.data() + written, (DWORD)(lines.size() - written), &n, NULL))
+				return false;
+#else
+			ssize_t n = write(toChild, lines.data() + written, lines.size() - written);
+			if (n <= 0)
+				return false;
+#endif
+			written += n;
+		}
+		return true;
+	}
+
+	bool Receive(const Simulator& game, PlayerId player, std::string& line, int timeout_ms) override {
+		if (!running) return false;
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+		while (true) {
+			size_t end = buffer.find('\n');
+			if (end != std::string::npos) {
+				line = buffer.substr(0, end);
+				buffer.erase(0, end + 1);
+				if (!line.empty() && line.back() == '\r')
+					line.pop_back();
+				return true;
+			}
+
+			long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+			if (remaining <= 0)
+				return false; // timed out
+
+			char data[4096];
+#ifdef _WIN32
+			DWORD available = 0;
+			if (!PeekNamedPipe(fromChild, NULL, 0, NULL, &available, NULL))
+				return false; // the bot died
+			if (available == 0) {
+				Sleep(1);
+				continue;
+			}
+			DWORD n;
+			if (!ReadFile(fromChild, data, std::min<DWORD>(available, sizeof(data)), &n, NULL) || n == 0)
+				return false;
+#else
+			pollfd pfd = { fromChild, POLLIN, 0 };
+			if (poll(&pfd, 1, (int)remaining) <= 0)
+				continue;
+			ssize_t n = read(fromChild, data, sizeof(data));
+			if (n <= 0)
+				return false; // the bot died
+#endif
+			buffer.append(data, n);
+		}
+	}
+
+private:
+	bool running = false;
+	std::string buffer;
+#ifdef _WIN32
+	HANDLE process = NULL, toChild = NULL, fromChild = NULL;
+#else
+	pid_t pid = -1;
+	int toChild = -1, fromChild = -1;
+#endif
+};
+
+/* The starter bot strategy (dock to the closest free planet, then go for the closest enemy), in-process */
+class StarterBot : public SimBot {
+public:
+	bool Send(const std::string& lines) override {
+		return true;
+	}
+
+	bool Receive(const Simulator& game, PlayerId player, std::string& line, int timeout_ms) override {
+		if (!initialized) {
+			initialized = true;
+			line = "starter";
+			return true;
+		}
+
+		std::ostringstream oss;
+		for (const SimShip& ship : game.ships) {
+			if (!ship.alive || ship.owner != player || ship.docking_status != 0) continue;
+
+			const SimPlanet* closestPlanet = 0;
+			double minDist = INF;
+			for (const SimPlanet& planet : game.planets) {
+				if (!planet.alive || (planet.owner != -1 && planet.owner != player) || planet.docked_ships.size() >= planet.docking_spots) continue;
+				double dist = ship.location.DistanceTo(planet.location) - planet.radius;
+				if (dist < minDist) {
+					minDist = dist;
+					closestPlanet = &planet;
+				}
+			}
+
+			Vector2 target;
+			double stop;
+			if (closestPlanet) {
+				if (minDist <= hlt::constants::DOCK_RADIUS + hlt::constants::SHIP_RADIUS) {
+					oss << "d " << ship.id << " " << closestPlanet->id << " ";
+					continue;
+				}
+				target = closestPlanet->location;
+				stop = closestPlanet->radius + hlt::constants::DOCK_RADIUS / 2;
+			}
+			else {
+				const SimShip* closestEnemy = 0;
+				for (const SimShip& enemy : game.ships) {
+					if (!enemy.alive || enemy.owner == player) continue;
+					double dist = ship.location.DistanceTo(enemy.location);
+					if (dist < minDist) {
+						minDist = dist;
+						closestEnemy = &enemy;
+					}
+				}
+				if (!closestEnemy) continue;
+				target = closestEnemy->location;
+				stop = hlt::constants::WEAPON_RADIUS / 2;
+			}
+
+			int thrust = std::min(hlt::constants::MAX_SPEED, std::max(0, (int)(ship.location.DistanceTo(target) - stop)));
+			int angle = radToDegClipped(std::atan2(target.y - ship.location.y, target.x - ship.location.x));
+			oss << "t " << ship.id << " " << thrust << " " << angle << " ";
+		}
+
+		line = oss.str();
+		return true;
+	}
+
+private:
+	bool initialized = false;
+};
+
+struct GameResult {
+	// by bot
+	std::vector<int> rankOfBot; // 0 = first
+	std::vector<double> averageMs, maxMs; // response time of the turns
+	std::vector<bool> failed; // crashed or timed out
+
+	int turns;
+	double seconds;
+};
+
+static std::unique_ptr<SimBot> CreateBot(const std::string& command) {
+	if (command == "starter")
+		return std::unique_ptr<SimBot>(new StarterBot());
+	return std::unique_ptr<SimBot>(new PipeBot(command));
+}
+
+// bot i plays as player (i + rotation) % players
+static GameResult PlayGame(const std::vector<std::string>& commands, int width, int height, unsigned int seed, int rotation) {
+	auto start = std::chrono::steady_clock::now();
+	const int players = (int)commands.size();
+
+	Simulator game(players, width, height, seed);
+
+	std::vector<std::unique_ptr<SimBot>> bots(players); // by player
+	for (int i = 0; i < players; i++)
+		bots[(i + rotation) % players] = CreateBot(commands[i]);
+
+	std::string frame = game.Serialize();
+	std::string line;
+
+	// by player
+	std::vector<double> totalMs(players, 0), maxMs(players, 0);
+	std::vector<int> responses(players, 0);
+	std::vector<bool> failed(players, false);
+
+	for (PlayerId player = 0; player < players; player++)
+		bots[player]->Send(game.InitLines(player) + frame + "\n");
+	for (PlayerId player = 0; player < players; player++) {
+		if (!bots[player]->Receive(game, player, line, INIT_TIMEOUT)) {
+			game.Eliminate(player);
+			failed[player] = true;
+		}
+	}
+
+	while (!game.IsFinished()) {
+		frame = game.Serialize() + "\n";
+
+		// all the bots think at the same time
+		std::vector<bool> playing(players);
+		for (PlayerId player = 0; player < players; player++)
+			playing[player] = game.IsAlive(player) && bots[player]->Send(frame);
+
+		auto sent = std::chrono::steady_clock::now();
+		for (PlayerId player = 0; player < players; player++) {
+			if (!game.IsAlive(player)) continue;
+			if (playing[player] && bots[player]->Receive(game, player, line, TURN_TIMEOUT)) {
+				// since the frame was sent (the bots run in parallel but are read in order, so it is an upper bound)
+				double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sent).count();
+				totalMs[player] += ms;
+				maxMs[player] = std::max(maxMs[player], ms);
+				responses[player]++;
+
+				game.SetMoves(player, line);
+			}
+			else {
+				game.Eliminate(player);
+				failed[player] = true;
+			}
+		}
+
+		game.Step();
+	}
+
+	GameResult result;
+	result.turns = game.turn;
+	result.rankOfBot.assign(players, 0);
+	std::vector<PlayerId> ranking = game.Ranking();
+	for (int rank = 0; rank < players; rank++) {
+		for (int i = 0; i < players; i++) {
+			if ((i + rotation) % players == ranking[rank])
+				result.rankOfBot[i] = rank;
+		}
+	}
+	for (int i = 0; i < players; i++) {
+		PlayerId player = (i + rotation) % players;
+		result.averageMs.push_back(responses[player] > 0 ? totalMs[player] / responses[player] : 0);
+		result.maxMs.push_back(maxMs[player]);
+		result.failed.push_back(failed[player]);
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+int main(int argc, char** argv) {
+#ifndef _WIN32
+	signal(SIGPIPE, SIG_IGN); // a dead bot must not kill us
+#endif
+
+	int games = 10;
+	int threads = std::max(1u, std::thread::hardware_concurrency());
+	int width = 0, height = 0; // random
+	unsigned int seed = (unsigned int)time(NULL);
+	bool quiet = false;
+	std::vector<std::string> commands;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-g" && i + 1 < argc) games = std::atoi(argv[++i]);
+		else if (arg == "-j" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "-W" && i + 1 < argc) width = std::atoi(argv[++i]);
+		else if (arg == "-H" && i + 1 < argc) height = std::atoi(argv[++i]);
+		else if (arg == "-s" && i + 1 < argc) seed = (unsigned int)std::strtoul(argv[++i], NULL, 10);
+		else if (arg == "-q") quiet = true;
+		else commands.push_back(arg);
+	}
+
+	if (commands.size() != 2 && commands.size() != 4) {
+		std::cerr << "Usage: SelfPlay.exe [-g games] [-j threads] [-W width -H height] [-s seed] [-q] bot1 bot2 [bot3 bot4]" << std::endl
+				  << "  a bot is a command or \"starter\" for the built-in starter bot" << std::endl;
+		return 1;
+	}
+
+	const int players = (int)commands.size();
+	std::vector<std::vector<int>> ranks(players, std::vector<int>(players, 0)); // bot -> rank -> count
+	int totalTurns = 0;
+	std::mutex mutex;
+	std::atomic<int> nextGame(0);
+
+	auto start = std::chrono::steady_clock::now();
+
+	auto worker = [&]() {
+		int g;
+		while ((g = nextGame++) < games) {
+			std::mt19937 rng(seed + g);
+			int w = width, h = height;
+			if (w == 0 || h == 0) {
+				// like the engine, 3:2 maps
+				w = std::uniform_int_distribution<int>(240, 384)(rng);
+				h = w * 2 / 3;
+			}
+
+			GameResult result = PlayGame(commands, w, h, seed + g, g % players);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			totalTurns += result.turns;
+			for (int i = 0; i < players; i++)
+				ranks[i][result.rankOfBot[i]]++;
+
+			if (quiet) {
+				std::cout << "result " << w << " " << h << " " << seed + g << " " << result.turns << " " << result.seconds;
+				for (int i = 0; i < players; i++)
+					std::cout << " " << result.rankOfBot[i] << " " << result.averageMs[i] << " " << result.maxMs[i] << " " << result.failed[i];
+				std::cout << std::endl;
+				continue;
+			}
+
+			std::cout << "Game " << g + 1 << "/" << games << " (" << w << "x" << h << " seed " << seed + g << ", " << result.turns << " turns, "
+					  << std::fixed << std::setprecision(1) << result.seconds << "s):";
+			for (int i = 0; i < players; i++) {
+				std::cout << " " << commands[i] << " #" << result.rankOfBot[i] + 1;
+				if (result.failed[i])
+					std::cout << " (failed)";
+			}
+			std::cout << std::endl;
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (int t = 0; t < std::min(threads, games); t++)
+		workers.push_back(std::thread(worker));
+	for (std::thread& t : workers)
+		t.join();
+
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (quiet)
+		return 0;
+
+	std::cout << std::endl;
+	for (int i = 0; i < players; i++) {
+		double averageRank = 0;
+		for (int r = 0; r < players; r++)
+			averageRank += (r + 1) * ranks[i][r];
+		std::cout << commands[i] << ": " << ranks[i][0] << " wins (" << std::fixed << std::setprecision(1) << 100.0 * ranks[i][0] / games << "%)"
+				  << " average rank " << std::setprecision(2) << averageRank / games << std::endl;
+	}
+	std::cout << games << " games, " << totalTurns << " turns in " << std::setprecision(1) << elapsed << "s ("
+			  << std::setprecision(0) << games / elapsed * 3600 << " games/hour)" << std::endl;
+
+	return 0;
+}
@@ -6,7 +6,7 @@
 #include "Navigation.hpp"
 #include "Log.hpp"
 
-Ship::Ship(EntityId id) : Entity(id)
+Ship::Ship(Instance* instance, EntityId id) : Entity(instance, id)
 {
 	navigationOptions.reserve(360 * 7 + 1);
 	navigationOptions.emplace_back(NavigationOption(0, 0));
@@ -24,8 +24,6 @@ bool Ship::IsCommandable() const {
 }
 
 bool Ship::CanDockToAnyPlanet() {
-	Instance* instance = Instance::Get();
-
 	for (auto& kv : instance->planets) {
 		Planet* planet = kv.second;
 		if (CanDock(planet)) {
@@ -56,8 +54,6 @@ int Ship::TurnsToBeUndocked() {
 
 void Ship::UpdateMaxThrusts()
 {
-	Instance* instance = Instance::Get();
-
 	for (int angle_deg = 0; angle_deg < 360; angle_deg++) {
 		max_thrusts[angle_deg] = 0;
 		while (max_thrusts[angle_deg] < 7) {
@@ -79,18 +75,21 @@ void Ship::UpdateMaxThrusts()
 
 std::pair<possibly<Move>, possibly<NavigationRequest*>> Ship::ComputeAction()
 {
-	NavigationRequest* navRequest = new NavigationRequest();
+	// the request is released with the arena at the start of the next turn
+	NavigationRequest* navRequest = instance->arena.New<NavigationRequest>(&instance->arena);
 
 	if (task_id == -1)
 		goto nomove;
 
 	{
-		Instance* instance = Instance::Get();
 
 		Task* task = instance->GetTask(task_id);
 
 		navRequest->ship = this;
 
+		// the trips that follow a distance field don't take the routes too
+		bool routed = false;
+
 		switch (task->type) {
 		case DOCK:
 		{
@@ -113,7 +112,6 @@ std::pair<possibly<Move>, possibly<NavigationRequest*>> Ship::ComputeAction()
 				// we're already docked
 
 				if (threatened || instance->game_over) {
-					delete navRequest;
 					return { { Move::undock(entity_id), true }, { 0, false } };
 				}
 
@@ -127,11 +125,12 @@ std::pair<possibly<Move>, possibly<NavigationRequest*>> Ship::ComputeAction()
 				bool waiting_for_write = instance->writing && instance->turns_writing < 25;
 
 				if (!threatened && !instance->game_over && !waiting_for_write) {
-					delete navRequest;
 					return { { Move::dock(entity_id, planet->entity_id), true },{ 0, false } };
 				}
 				else {
-					Log::log("Ship " + std::to_string(entity_id) + " can't dock because of threats!");
+#ifdef HALITE_LOCAL
+					instance->logger.log("Ship " + std::to_string(entity_id) + " can't dock because of threats!");
+#endif
 					// at this point we can dock but we are threatened, so we try to get the furthest from the enemy ships while being able to dock
 
 					Ship* closestEnemyShip = instance->GetClosestShip(location, false);
@@ -146,8 +145,9 @@ std::pair<possibly<Move>, possibly<NavigationRequest*>> Ship::ComputeAction()
 				}
 			}
 
-			// continue navigating to the planet
+			// continue navigating to the planet (around the planets in the way)
 			navRequest->targetLocation = location.ClosestPointTo(planet->location, planet->radius);
+			routed = instance->fields.Waypoint(instance->fields.PlanetField(planet->entity_id), location, navRequest->targetLocation);
 			navRequest->avoid_enemies = true;
 			break;
 		}
@@ -166,7 +166,7 @@ std::pair<possibly<Move>, possibly<NavigationRequest*>> Ship::ComputeAction()
 			navRequest->avoid_enemies = false;
 			/*
 			if (location.DistanceTo(shipTarget->location) > (hlt::constants::SHIP_RADIUS + hlt::constants::MAX_SPEED + hlt::constants::WEAPON_RADIUS) * 2) {
-				Log::log() << "Ship " << entity_id << " is too far away, we'll avoid enemies until we reach the target " << shipTarget->entity_id << std::endl;
+				instance->logger.log() << "Ship " << entity_id << " is too far away, we'll avoid enemies until we reach the target " << shipTarget->entity_id << std::endl;
 				navRequest->avoid_enemies = true;
 			}
 			*/
@@ -193,17 +193,23 @@ std::pair<possibly<Move>, possibly<NavigationRequest*>> Ship::ComputeAction()
 		case WRITE:
 		case ESCAPE: // run bitch
 			navRequest->targetLocation = task->location;
+			if (task->type == ESCAPE)
+				routed = instance->fields.Waypoint(instance->fields.CornerField(task->key), location, navRequest->targetLocation);
 			navRequest->avoid_enemies = true;
 			break;
 		default:
 		case NOTHING:
-			Log::log() << "Ship " << entity_id << " has an invalid task!" << std::endl;
+			instance->logger.log() << "Ship " << entity_id << " has an invalid task!" << std::endl;
 			goto nomove;
 		}
 
-		Log::log() << "Ship " << entity_id << " is moving from " << navRequest->ship->location << " towards " << navRequest->targetLocation << " avoiding enemies: " << navRequest->avoid_enemies << std::endl;
+		// the long trips go around the planets, the options only see MAX_SPEED ahead
+		if (!routed && navRequest->avoid_obstacles && location.DistanceTo(navRequest->targetLocation) > hlt::constants::MAX_SPEED * 2)
+			navRequest->targetLocation = instance->routes.NextWaypoint(location, navRequest->targetLocation);
+
+		instance->logger.log() << "Ship " << entity_id << " is moving from " << navRequest->ship->location << " towards " << navRequest->targetLocation << " avoiding enemies: " << navRequest->avoid_enemies << std::endl;
 		if (navRequest->targetLocation.DistanceTo(location) < sqrt(2) - 0.1) {
-			Log::log() << "... but ship it's already there..." << std::endl;
+			instance->logger.log() << "... but ship it's already there..." << std::endl;
 			// goto nomove; don't enable this, the ship should avoid enemies if necessary
 		}
 
@@ -211,6 +217,5 @@ std::pair<possibly<Move>, possibly<NavigationRequest*>> Ship::ComputeAction()
 	}
 
 nomove:
-	delete navRequest;
 	return { { Move::noop(), false },{ 0, false } };
 }
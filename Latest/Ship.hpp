@@ -13,7 +13,7 @@ enum class ShipDockingStatus {
 
 class Ship : public Entity {
 public:
-	Ship(EntityId id);
+	Ship(Instance* instance, EntityId id);
 
 	bool IsCommandable() const;
 	bool CanDockToAnyPlanet();
@@ -31,6 +31,7 @@ public:
 
 	// Task System
 	unsigned int task_id = -1;
+	unsigned int last_task_id = -1; // task of the last turn
 	double task_priority = 0;
 
 	// Navigation
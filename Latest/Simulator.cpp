@@ -0,0 +1,682 @@
+#include "Simulator.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+using namespace hlt::constants;
+
+// edge to edge distance at which a ship can shoot
+const double ATTACK_RANGE = WEAPON_RADIUS + SHIP_RADIUS * 2;
+// two ships farther than this at the start of the turn can't interact
+const double INTERACTION_RANGE = MAX_SPEED * 2 + ATTACK_RANGE;
+// events closer than this in time are simultaneous (like the engine)
+const double EVENT_TIME_PRECISION = 10000;
+const int INITIAL_SHIPS = 3;
+
+enum SimEventType {
+	EVENT_ATTACK,
+	EVENT_SHIP_COLLISION,
+	EVENT_PLANET_COLLISION,
+	EVENT_OUT_OF_MAP,
+};
+
+struct SimEvent {
+	long long time; // in EVENT_TIME_PRECISION units
+	SimEventType type;
+	int a, b; // indices in ships (b is a planet index for EVENT_PLANET_COLLISION)
+
+	bool operator<(const SimEvent& other) const {
+		if (time != other.time) return time < other.time;
+		if (type != other.type) return type < other.type;
+		if (a != other.a) return a < other.a;
+		return b < other.b;
+	}
+};
+
+// first time in [0, 1] at which the distance between both circles' centers is r
+static bool CollisionTime(double r, const Vector2& loc1, const Vector2& loc2, const Vector2& vel1, const Vector2& vel2, double& time) {
+	const double dx = loc1.x - loc2.x, dy = loc1.y - loc2.y;
+	const double dvx = vel1.x - vel2.x, dvy = vel1.y - vel2.y;
+
+	const double c = dx * dx + dy * dy - r * r;
+	if (c <= 0) {
+		time = 0;
+		return true;
+	}
+
+	const double a = dvx * dvx + dvy * dvy;
+	if (a == 0)
+		return false;
+
+	const double b = 2 * (dx * dvx + dy * dvy);
+	const double disc = b * b - 4 * a * c;
+	if (disc < 0)
+		return false;
+
+	time = (-b - std::sqrt(disc)) / (2 * a);
+	return time >= 0 && time <= 1;
+}
+
+static Vector2 PositionAt(const SimShip& ship, double time) {
+	return ship.location + ship.velocity * time;
+}
+
+Simulator::Simulator(int num_players, int map_width, int map_height, unsigned int seed)
+	: num_players(num_players), map_width(map_width), map_height(map_height), turn(0), rng(seed), next_ship_id(0)
+{
+	max_turns = 100 + (int)std::sqrt(map_width * map_height);
+	last_turn_alive.assign(num_players, 0);
+	damage_dealt.assign(num_players, 0);
+
+	// starting positions, symmetric
+	std::vector<Vector2> starts;
+	if (num_players == 2) {
+		starts.push_back({ map_width * 0.25, map_height * 0.5 });
+		starts.push_back({ map_width * 0.75, map_height * 0.5 });
+	}
+	else {
+		starts.push_back({ map_width * 0.25, map_height * 0.25 });
+		starts.push_back({ map_width * 0.75, map_height * 0.25 });
+		starts.push_back({ map_width * 0.25, map_height * 0.75 });
+		starts.push_back({ map_width * 0.75, map_height * 0.75 });
+	}
+
+	for (PlayerId player = 0; player < num_players; player++) {
+		for (int i = 0; i < INITIAL_SHIPS; i++)
+			SpawnShip(player, starts[player] + Vector2{ 0, (i - 1) * 2.0 });
+	}
+
+	GeneratePlanets();
+}
+
+void Simulator::GeneratePlanets()
+{
+	const Vector2 center = { map_width / 2.0, map_height / 2.0 };
+
+	auto isFree = [&](const Vector2& location, double radius) {
+		if (location.x - radius < 5 || location.y - radius < 5 || location.x + radius > map_width - 5 || location.y + radius > map_height - 5)
+			return false;
+		for (const SimPlanet& planet : planets) {
+			if (planet.location.DistanceTo(location) < planet.radius + radius + 5)
+				return false;
+		}
+		for (const SimShip& ship : ships) {
+			if (ship.location.DistanceTo(location) < radius + 10)
+				return false;
+		}
+		return true;
+	};
+
+	auto addPlanet = [&](const Vector2& location, double radius) {
+		SimPlanet planet;
+		planet.id = (EntityId)planets.size();
+		planet.location = location;
+		planet.radius = radius;
+		planet.health = (int)(radius * MAX_SHIP_HEALTH);
+		planet.docking_spots = std::max(2, (int)(radius / 2));
+		planet.current_production = 0;
+		planet.remaining_production = planet.health;
+		planet.owner = -1;
+		planet.alive = true;
+		planets.push_back(planet);
+	};
+
+	// the symmetric copies of a point (the first one is the point itself)
+	auto mirrors = [&](const Vector2& p) {
+		std::vector<Vector2> result;
+		result.push_back(p);
+		if (num_players == 2) {
+			result.push_back({ map_width - p.x, map_height - p.y });
+		}
+		else {
+			result.push_back({ map_width - p.x, p.y });
+			result.push_back({ p.x, map_height - p.y });
+			result.push_back({ map_width - p.x, map_height - p.y });
+		}
+		return result;
+	};
+
+	// 4 planets in the center
+	std::uniform_real_distribution<double> centerRadius(4, 8);
+	double radius = centerRadius(rng);
+	double separation = radius * 2 + 4;
+	addPlanet(center + Vector2{ -separation, -separation } / 2, radius);
+	addPlanet(center + Vector2{ separation, -separation } / 2, radius);
+	addPlanet(center + Vector2{ -separation, separation } / 2, radius);
+	addPlanet(center + Vector2{ separation, separation } / 2, radius);
+
+	// and the rest in symmetric groups
+	std::uniform_real_distribution<double> radiusDist(3, 8);
+	std::uniform_real_distribution<double> xDist(0, num_players == 2 ? map_width : map_width / 2.0);
+	std::uniform_real_distribution<double> yDist(0, map_height / 2.0);
+	int groups = num_players == 2 ? std::uniform_int_distribution<int>(4, 8)(rng) : std::uniform_int_distribution<int>(3, 5)(rng);
+
+	for (int g = 0; g < groups; g++) {
+		for (int attempt = 0; attempt < 100; attempt++) {
+			double r = radiusDist(rng);
+			std::vector<Vector2> locations = mirrors({ xDist(rng), yDist(rng) });
+
+			bool free = true;
+			for (int i = 0; free && i < locations.size(); i++) {
+				free = isFree(locations[i], r);
+				for (int j = 0; free && j < i; j++)
+					free = locations[i].DistanceTo(locations[j]) > r * 2 + 5;
+			}
+
+			if (free) {
+				for (const Vector2& location : locations)
+					addPlanet(location, r);
+				break;
+			}
+		}
+	}
+}
+
+void Simulator::SpawnShip(PlayerId owner, const Vector2& location)
+{
+	SimShip ship;
+	ship.id = next_ship_id++;
+	ship.owner = owner;
+	ship.location = location;
+	ship.velocity = { 0, 0 };
+	ship.health = BASE_SHIP_HEALTH;
+	ship.docking_status = 0;
+	ship.docked_planet = 0;
+	ship.docking_progress = 0;
+	ship.weapon_cooldown = 0;
+	ship.alive = true;
+
+	shipIndex[ship.id] = (int)ships.size();
+	ships.push_back(ship);
+}
+
+std::string Simulator::InitLines(PlayerId player) const
+{
+	std::ostringstream oss;
+	oss << player << "\n" << map_width << " " << map_height << "\n";
+	return oss.str();
+}
+
+std::string Simulator::Serialize() const
+{
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(4);
+
+	oss << num_players;
+	for (PlayerId player = 0; player < num_players; player++) {
+		int count = 0;
+		for (const SimShip& ship : ships)
+			if (ship.alive && ship.owner == player)
+				count++;
+
+		oss << " " << player << " " << count;
+		for (const SimShip& ship : ships) {
+			if (!ship.alive || ship.owner != player) continue;
+			// the velocity is deprecated, always 0
+			oss << " " << ship.id << " " << ship.location.x << " " << ship.location.y << " " << ship.health
+				<< " 0 0 " << ship.docking_status << " " << ship.docked_planet << " " << ship.docking_progress << " " << ship.weapon_cooldown;
+		}
+	}
+
+	int count = 0;
+	for (const SimPlanet& planet : planets)
+		if (planet.alive)
+			count++;
+
+	oss << " " << count;
+	for (const SimPlanet& planet : planets) {
+		if (!planet.alive) continue;
+		oss << " " << planet.id << " " << planet.location.x << " " << planet.location.y << " " << planet.health << " " << planet.radius
+			<< " " << planet.docking_spots << " " << planet.current_production << " " << planet.remaining_production
+			<< " " << (planet.owner != -1 ? 1 : 0) << " " << std::max(planet.owner, 0) << " " << planet.docked_ships.size();
+		for (EntityId ship_id : planet.docked_ships)
+			oss << " " << ship_id;
+	}
+
+	return oss.str();
+}
+
+void Simulator::SetMoves(PlayerId player, const std::string& moves)
+{
+	std::istringstream iss(moves);
+	std::string type;
+	std::vector<EntityId> commanded;
+
+	while (iss >> type) {
+		EntityId ship_id;
+		if (!(iss >> ship_id)) break;
+
+		SimShip* ship = GetShip(ship_id);
+		bool valid = ship && ship->alive && ship->owner == player
+			&& std::find(commanded.begin(), commanded.end(), ship_id) == commanded.end(); // one move per ship
+
+		if (type == "t") {
+			int thrust, angle;
+			if (!(iss >> thrust >> angle)) break;
+			if (!valid || ship->docking_status != 0 || thrust < 0 || thrust > MAX_SPEED) continue;
+
+			const int angle_deg = ((angle % 360) + 360) % 360; // the message in the angle is ignored
+			const double angle_rad = angle_deg * M_PI / 180.0;
+			ship->velocity = { std::cos(angle_rad) * thrust, std::sin(angle_rad) * thrust };
+		}
+		else if (type == "d") {
+			EntityId planet_id;
+			if (!(iss >> planet_id)) break;
+			if (!valid || ship->docking_status != 0) continue;
+
+			const SimPlanet* planet = GetPlanet(planet_id);
+			if (!planet || !planet->alive) continue;
+			if (ship->location.DistanceTo(planet->location) > planet->radius + DOCK_RADIUS + SHIP_RADIUS) continue;
+			if (planet->owner != -1 && planet->owner != player) continue;
+
+			dockRequests.push_back(std::make_pair(ship_id, planet_id));
+		}
+		else if (type == "u") {
+			if (!valid || ship->docking_status != 2) continue;
+			ship->docking_status = 3;
+			ship->docking_progress = DOCK_TURNS;
+		}
+		else
+			break; // garbage
+
+		commanded.push_back(ship_id);
+	}
+}
+
+void Simulator::Step()
+{
+	ProcessDocking();
+	ProcessProduction();
+	ProcessMovement();
+
+	for (SimShip& ship : ships) {
+		ship.velocity = { 0, 0 };
+		if (ship.weapon_cooldown > 0)
+			ship.weapon_cooldown--;
+	}
+
+	RemoveDeadShips();
+
+	turn++;
+	for (PlayerId player = 0; player < num_players; player++)
+		if (IsAlive(player))
+			last_turn_alive[player] = turn;
+}
+
+void Simulator::ProcessDocking()
+{
+	// the ships that were already docking or undocking
+	for (SimShip& ship : ships) {
+		if (!ship.alive) continue;
+
+		if (ship.docking_status == 1) {
+			if (--ship.docking_progress <= 0) {
+				ship.docking_progress = 0;
+				ship.docking_status = 2;
+			}
+		}
+		else if (ship.docking_status == 3) {
+			if (--ship.docking_progress <= 0) {
+				ship.docking_progress = 0;
+				ship.docking_status = 0;
+
+				SimPlanet& planet = planets[ship.docked_planet];
+				planet.docked_ships.erase(std::remove(planet.docked_ships.begin(), planet.docked_ships.end(), ship.id), planet.docked_ships.end());
+				if (planet.docked_ships.empty())
+					planet.owner = -1;
+				ship.docked_planet = 0;
+			}
+		}
+	}
+
+	// the new ones, if players of different teams try to dock to the same free planet nobody docks
+	std::sort(dockRequests.begin(), dockRequests.end());
+	for (SimPlanet& planet : planets) {
+		PlayerId first_owner = -1;
+		bool contested = false;
+		for (auto& request : dockRequests) {
+			if (request.second != planet.id) continue;
+			PlayerId owner = GetShip(request.first)->owner;
+			if (first_owner == -1)
+				first_owner = owner;
+			else if (owner != first_owner)
+				contested = true;
+		}
+		if (first_owner == -1 || (contested && planet.owner == -1))
+			continue;
+
+		for (auto& request : dockRequests) {
+			if (request.second != planet.id) continue;
+			if (planet.docked_ships.size() >= planet.docking_spots) break;
+
+			SimShip* ship = GetShip(request.first);
+			if (planet.owner != -1 && planet.owner != ship->owner) continue;
+
+			ship->docking_status = 1;
+			ship->docking_progress = DOCK_TURNS;
+			ship->docked_planet = planet.id;
+			planet.docked_ships.push_back(ship->id);
+			planet.owner = ship->owner;
+		}
+	}
+	dockRequests.clear();
+}
+
+void Simulator::ProcessProduction()
+{
+	const Vector2 center = { map_width / 2.0, map_height / 2.0 };
+
+	for (SimPlanet& planet : planets) {
+		if (!planet.alive || planet.owner == -1) continue;
+
+		int docked = 0;
+		for (EntityId ship_id : planet.docked_ships)
+			if (GetShip(ship_id)->docking_status == 2)
+				docked++;
+
+		planet.current_production += docked * BASE_PRODUCTIVITY;
+
+		while (planet.current_production >= PRODUCTION_PER_SHIP) {
+			// the free spot around the planet closest to the center of the map
+			Vector2 best_location = { -1, -1 };
+			double best_distance = 1e9;
+			const double open_radius = SHIP_RADIUS * 3;
+
+			for (int dx = -SPAWN_RADIUS; dx <= SPAWN_RADIUS; dx++) {
+				for (int dy = -SPAWN_RADIUS; dy <= SPAWN_RADIUS; dy++) {
+					const double offset_angle = std::atan2(dy, dx);
+					const Vector2 location = planet.location + Vector2{ dx + planet.radius * std::cos(offset_angle), dy + planet.radius * std::sin(offset_angle) };
+
+					if (location.x < 0 || location.y < 0 || location.x >= map_width || location.y >= map_height)
+						continue;
+
+					bool occupied = false;
+					for (const SimShip& ship : ships) {
+						if (ship.alive && location.DistanceTo(ship.location) <= open_radius + SHIP_RADIUS) {
+							occupied = true;
+							break;
+						}
+					}
+
+					const double distance = location.DistanceTo(center);
+					if (!occupied && distance < best_distance) {
+						best_distance = distance;
+						best_location = location;
+					}
+				}
+			}
+
+			if (best_location.x == -1)
+				break; // no room, we keep the production for the next turn
+
+			SpawnShip(planet.owner, best_location);
+			planet.current_production -= PRODUCTION_PER_SHIP;
+		}
+	}
+}
+
+void Simulator::DamagePlanet(SimPlanet& planet, int damage, double time)
+{
+	if (!planet.alive) return;
+
+	planet.health -= damage;
+	if (planet.health > 0) return;
+
+	planet.alive = false;
+	planet.health = 0;
+
+	// the docked ships go with it and the explosion damages the ships around
+	// (linearly less with the distance to the surface)
+	for (SimShip& ship : ships) {
+		if (!ship.alive) continue;
+
+		if (ship.docking_status != 0 && ship.docked_planet == planet.id) {
+			ship.alive = false;
+			continue;
+		}
+
+		const double distance = PositionAt(ship, time).DistanceTo(planet.location) - planet.radius;
+		if (distance < EXPLOSION_RADIUS) {
+			ship.health -= (int)(MAX_SHIP_HEALTH * (1 - std::max(0.0, distance) / EXPLOSION_RADIUS));
+			if (ship.health <= 0)
+				ship.alive = false;
+		}
+	}
+}
+
+void Simulator::ProcessMovement()
+{
+	std::vector<SimEvent> events;
+	std::vector<std::vector<int>> enemies(ships.size()); // the enemies in INTERACTION_RANGE
+
+	auto addEvent = [&](double time, SimEventType type, int a, int b) {
+		events.push_back({ (long long)std::floor(time * EVENT_TIME_PRECISION), type, a, b });
+	};
+
+	// bucket the ships so we only check the pairs that can interact
+	const int cols = (int)(map_width / INTERACTION_RANGE) + 1;
+	const int rows = (int)(map_height / INTERACTION_RANGE) + 1;
+	std::vector<std::vector<int>> grid(cols * rows);
+	auto cellOf = [&](const Vector2& location, int& cx, int& cy) {
+		cx = std::min(std::max((int)(location.x / INTERACTION_RANGE), 0), cols - 1);
+		cy = std::min(std::max((int)(location.y / INTERACTION_RANGE), 0), rows - 1);
+	};
+
+	for (int i = 0; i < ships.size(); i++) {
+		if (!ships[i].alive) continue;
+		int cx, cy;
+		cellOf(ships[i].location, cx, cy);
+		grid[cy * cols + cx].push_back(i);
+	}
+
+	double time;
+	for (int i = 0; i < ships.size(); i++) {
+		const SimShip& a = ships[i];
+		if (!a.alive) continue;
+
+		int cx, cy;
+		cellOf(a.location, cx, cy);
+		for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, rows - 1); y++) {
+			for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, cols - 1); x++) {
+				for (int j : grid[y * cols + x]) {
+					if (j <= i) continue;
+					const SimShip& b = ships[j];
+					if (a.location.DistanceTo(b.location) > INTERACTION_RANGE) continue;
+
+					if (CollisionTime(SHIP_RADIUS * 2, a.location, b.location, a.velocity, b.velocity, time))
+						addEvent(time, EVENT_SHIP_COLLISION, i, j);
+
+					if (a.owner != b.owner) {
+						enemies[i].push_back(j);
+						enemies[j].push_back(i);
+						if (CollisionTime(ATTACK_RANGE, a.location, b.location, a.velocity, b.velocity, time))
+							addEvent(time, EVENT_ATTACK, i, j);
+					}
+				}
+			}
+		}
+
+		if (a.velocity.x == 0 && a.velocity.y == 0) continue;
+
+		for (int p = 0; p < planets.size(); p++) {
+			const SimPlanet& planet = planets[p];
+			if (!planet.alive || a.location.DistanceTo(planet.location) > planet.radius + SHIP_RADIUS + MAX_SPEED) continue;
+			if (CollisionTime(planet.radius + SHIP_RADIUS, a.location, planet.location, a.velocity, { 0, 0 }, time))
+				addEvent(time, EVENT_PLANET_COLLISION, i, p);
+		}
+
+		// leaving the map
+		const Vector2 end = a.location + a.velocity;
+		double out = 2;
+		if (end.x < 0) out = std::min(out, -a.location.x / a.velocity.x);
+		if (end.y < 0) out = std::min(out, -a.location.y / a.velocity.y);
+		if (end.x > map_width) out = std::min(out, (map_width - a.location.x) / a.velocity.x);
+		if (end.y > map_height) out = std::min(out, (map_height - a.location.y) / a.velocity.y);
+		if (out <= 1)
+			addEvent(out, EVENT_OUT_OF_MAP, i, -1);
+	}
+
+	std::sort(events.begin(), events.end());
+
+	std::vector<std::pair<int, int>> damages; // ship, damage
+	std::vector<int> targets;
+
+	for (int start = 0; start < events.size();) {
+		// the events at the same time are solved together
+		int end = start;
+		while (end < events.size() && events[end].time == events[start].time)
+			end++;
+		const double t = events[start].time / EVENT_TIME_PRECISION;
+
+		// attacks, every ship shoots once, splitting the damage between all the enemies in range
+		damages.clear();
+		for (int e = start; e < end; e++) {
+			if (events[e].type != EVENT_ATTACK) continue;
+
+			for (int shooter : { events[e].a, events[e].b }) {
+				SimShip& ship = ships[shooter];
+				if (!ship.alive || ship.docking_status != 0 || ship.weapon_cooldown > 0) continue;
+
+				const Vector2 position = PositionAt(ship, t);
+				targets.clear();
+				for (int enemy : enemies[shooter]) {
+					if (ships[enemy].alive && PositionAt(ships[enemy], t).DistanceTo(position) <= ATTACK_RANGE + 1e-6)
+						targets.push_back(enemy);
+				}
+				if (targets.empty()) continue;
+
+				ship.weapon_cooldown = WEAPON_COOLDOWN;
+				const int damage = WEAPON_DAMAGE / (int)targets.size();
+				for (int target : targets)
+					damages.push_back(std::make_pair(target, damage));
+				damage_dealt[ship.owner] += damage * (int)targets.size();
+			}
+		}
+
+		// collisions
+		for (int e = start; e < end; e++) {
+			SimShip& a = ships[events[e].a];
+			if (!a.alive) continue;
+
+			switch (events[e].type) {
+			case EVENT_SHIP_COLLISION:
+			{
+				SimShip& b = ships[events[e].b];
+				if (!b.alive) continue;
+				a.alive = false;
+				b.alive = false;
+				break;
+			}
+			case EVENT_PLANET_COLLISION:
+				a.alive = false;
+				DamagePlanet(planets[events[e].b], a.health, t);
+				break;
+			case EVENT_OUT_OF_MAP:
+				a.alive = false;
+				break;
+			default:
+				break;
+			}
+		}
+
+		for (auto& damage : damages) {
+			SimShip& ship = ships[damage.first];
+			if (!ship.alive) continue;
+			ship.health -= damage.second;
+			if (ship.health <= 0)
+				ship.alive = false;
+		}
+
+		start = end;
+	}
+
+	for (SimShip& ship : ships) {
+		if (ship.alive)
+			ship.location = ship.location + ship.velocity;
+	}
+}
+
+void Simulator::RemoveDeadShips()
+{
+	for (SimShip& ship : ships) {
+		if (ship.alive || ship.docking_status == 0) continue;
+
+		SimPlanet& planet = planets[ship.docked_planet];
+		planet.docked_ships.erase(std::remove(planet.docked_ships.begin(), planet.docked_ships.end(), ship.id), planet.docked_ships.end());
+		if (planet.docked_ships.empty())
+			planet.owner = -1;
+	}
+
+	ships.erase(std::remove_if(ships.begin(), ships.end(), [](const SimShip& ship) { return !ship.alive; }), ships.end());
+
+	shipIndex.clear();
+	for (int i = 0; i < ships.size(); i++)
+		shipIndex[ships[i].id] = i;
+}
+
+void Simulator::Eliminate(PlayerId player)
+{
+	for (SimShip& ship : ships) {
+		if (ship.owner == player)
+			ship.alive = false;
+	}
+	RemoveDeadShips();
+}
+
+bool Simulator::IsAlive(PlayerId player) const
+{
+	for (const SimShip& ship : ships) {
+		if (ship.alive && ship.owner == player)
+			return true;
+	}
+	return false;
+}
+
+bool Simulator::IsFinished() const
+{
+	int alive = 0;
+	for (PlayerId player = 0; player < num_players; player++)
+		if (IsAlive(player))
+			alive++;
+	return alive <= 1 || turn >= max_turns;
+}
+
+std::vector<PlayerId> Simulator::Ranking() const
+{
+	// the players that lasted more first, then the ones with more ships and then more health
+	std::vector<int> shipCount(num_players, 0), totalHealth(num_players, 0);
+	for (const SimShip& ship : ships) {
+		if (!ship.alive) continue;
+		shipCount[ship.owner]++;
+		totalHealth[ship.owner] += ship.health;
+	}
+
+	std::vector<PlayerId> ranking;
+	for (PlayerId player = 0; player < num_players; player++)
+		ranking.push_back(player);
+
+	std::stable_sort(ranking.begin(), ranking.end(), [&](PlayerId a, PlayerId b) {
+		if (last_turn_alive[a] != last_turn_alive[b]) return last_turn_alive[a] > last_turn_alive[b];
+		if (shipCount[a] != shipCount[b]) return shipCount[a] > shipCount[b];
+		return totalHealth[a] > totalHealth[b];
+	});
+
+	return ranking;
+}
+
+SimShip* Simulator::GetShip(EntityId id)
+{
+	auto it = shipIndex.find(id);
+	if (it == shipIndex.end())
+		return nullptr;
+	return &ships[(*it).second];
+}
+
+const SimPlanet* Simulator::GetPlanet(EntityId id) const
+{
+	if (id < 0 || id >= planets.size())
+		return nullptr;
+	return &planets[id];
+}
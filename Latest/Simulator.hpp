@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <random>
+#include <unordered_map>
+
+#include "constants.hpp"
+#include "Types.hpp"
+#include "Vector2.hpp"
+
+/*
+	Headless implementation of the Halite II rules, to play games
+	without halite.exe (see SelfPlay.cpp)
+
+	A turn is:
+	 - the moves of every player are applied (thrust, dock, undock)
+	 - docking and undocking progress
+	 - production and spawning of the new ships
+	 - movement, solving in time order the collisions (ship-ship, ship-planet,
+	   leaving the map) and the attacks
+	 - cooldowns
+
+	The frames are serialized in the same format the engine sends.
+*/
+
+struct SimShip {
+	EntityId id;
+	PlayerId owner;
+	Vector2 location;
+	Vector2 velocity;
+	int health;
+	int docking_status; // 0 undocked, 1 docking, 2 docked, 3 undocking (like ShipDockingStatus)
+	EntityId docked_planet;
+	int docking_progress;
+	int weapon_cooldown;
+	bool alive;
+};
+
+struct SimPlanet {
+	EntityId id;
+	Vector2 location;
+	double radius;
+	int health;
+	int docking_spots;
+	int current_production;
+	int remaining_production;
+	PlayerId owner; // -1 if not owned
+	std::vector<EntityId> docked_ships;
+	bool alive;
+};
+
+class Simulator {
+public:
+	Simulator(int num_players, int map_width, int map_height, unsigned int seed);
+
+	// the first lines that every bot receives (without the frame)
+	std::string InitLines(PlayerId player) const;
+	// the map line, as the engine sends it
+	std::string Serialize() const;
+
+	// parses the moves line of a player, the invalid moves are ignored
+	void SetMoves(PlayerId player, const std::string& moves);
+	// simulates the turn with the moves set
+	void Step();
+
+	// the player is out (it crashed or timed out), its ships are destroyed
+	void Eliminate(PlayerId player);
+
+	bool IsFinished() const;
+	bool IsAlive(PlayerId player) const;
+	// best first
+	std::vector<PlayerId> Ranking() const;
+
+	SimShip* GetShip(EntityId id);
+	const SimPlanet* GetPlanet(EntityId id) const;
+
+	int num_players;
+	int map_width, map_height;
+	int turn;
+	int max_turns;
+
+	std::vector<SimShip> ships;
+	std::vector<SimPlanet> planets;
+
+	// stats
+	std::vector<int> last_turn_alive;
+	std::vector<int> damage_dealt;
+
+private:
+	void GeneratePlanets();
+	void SpawnShip(PlayerId owner, const Vector2& location);
+
+	void ProcessDocking();
+	void ProcessProduction();
+	void ProcessMovement();
+	void DamagePlanet(SimPlanet& planet, int damage, double time);
+	void RemoveDeadShips();
+
+	std::mt19937 rng;
+	EntityId next_ship_id;
+
+	std::unordered_map<EntityId, int> shipIndex; // id -> index in ships
+	std::vector<std::pair<EntityId, EntityId>> dockRequests; // ship, planet
+};
@@ -0,0 +1,278 @@
+#include "Skirmish.hpp"
+
+#include <random>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "Instance.hpp"
+
+// moves tried for every ship (heuristic, stay, best scored, directions)
+const int SKIRMISH_MAX_CANDIDATES = 14;
+const int SKIRMISH_BEST_SCORED = 3;
+const int SKIRMISH_DIRECTIONS = 8;
+// sampled joint responses of the enemies, every joint move is evaluated against all of them
+const int SKIRMISH_SCENARIOS = 6;
+// passes over all the ships
+const int SKIRMISH_MAX_PASSES = 4;
+// health per unit of distance to the target, so the ships keep going when the fight is even
+const double SKIRMISH_DISTANCE_WEIGHT = 1;
+
+struct SkirmishMove {
+	int angle;
+	int thrust;
+
+	bool operator==(const SkirmishMove& other) const {
+		return angle == other.angle && thrust == other.thrust;
+	}
+};
+
+struct SkirmishDecision {
+	NavigationRequest* navReq;
+	int index; // in the combat
+	bool fixed; // avoiding enemies, it keeps the heuristic move
+	SkirmishMove candidates[SKIRMISH_MAX_CANDIDATES];
+	int candidates_count = 0;
+	int current = 0; // candidate, 0 is the heuristic move
+
+	void AddCandidate(const SkirmishMove& move) {
+		if (candidates_count == SKIRMISH_MAX_CANDIDATES) return;
+		for (int i = 0; i < candidates_count; i++) {
+			if (candidates[i] == move) return;
+		}
+		candidates[candidates_count++] = move;
+	}
+};
+
+int Skirmish::Search(Instance* instance, const ArenaVector<NavigationRequest*>& component, long long time_limit)
+{
+	Vector2 center = { 0, 0 };
+	for (NavigationRequest* navReq : component)
+		center = center + navReq->ship->location;
+	center = center / (double)component.size();
+
+	double radius = 0;
+	for (NavigationRequest* navReq : component)
+		radius = std::max(radius, center.DistanceTo(navReq->ship->location));
+
+	Combat initial;
+	initial.Clear(instance->map_width, instance->map_height);
+	initial.AddShipsAround(instance, center, radius + COMBAT_RANGE);
+
+	// our ships, the ones we decide
+	SkirmishDecision decisions[COMBAT_MAX_SHIPS];
+	int decisions_count = 0;
+
+	for (NavigationRequest* navReq : component) {
+		Ship* ship = navReq->ship;
+		int index = initial.FindShip(ship->entity_id);
+		if (index == -1) continue;
+
+		SkirmishDecision& decision = decisions[decisions_count++];
+		decision.navReq = navReq;
+		decision.index = index;
+		// only the ships that are looking for a fight are searched (ATTACK, DEFEND...)
+		decision.fixed = navReq->avoid_enemies;
+
+		auto isValid = [&](int angle, int thrust) {
+			return thrust <= ship->max_thrusts[angle] && !Navigation::IsOutsideTheMap(instance, ship->location + instance->velocityCache[angle][thrust]);
+		};
+
+		// what PickOptions would pick without conflicts (stay if nothing is good)
+		SkirmishMove heuristic = { 0, 0 };
+		for (const NavigationOption& option : ship->navigationOptions) {
+			if (option.score > -99 && isValid(option.angle, option.thrust)) {
+				heuristic = { option.angle, option.thrust };
+				break;
+			}
+		}
+		decision.AddCandidate(heuristic);
+		if (decision.fixed) continue;
+		decision.AddCandidate({ 0, 0 });
+
+		int scored = 0;
+		for (const NavigationOption& option : ship->navigationOptions) {
+			if (scored == SKIRMISH_BEST_SCORED || option.score <= -99) break;
+			if (isValid(option.angle, option.thrust)) {
+				decision.AddCandidate({ option.angle, option.thrust });
+				scored++;
+			}
+		}
+
+		for (int d = 0; d < SKIRMISH_DIRECTIONS; d++) {
+			int angle = d * 360 / SKIRMISH_DIRECTIONS;
+			int thrust = std::min(ship->max_thrusts[angle], hlt::constants::MAX_SPEED);
+			if (thrust > 0 && isValid(angle, thrust))
+				decision.AddCandidate({ angle, thrust });
+		}
+	}
+
+	// the enemies that can move and the closest of our ships to them
+	int enemies[COMBAT_MAX_SHIPS];
+	int enemies_count = 0;
+	Vector2 charge[COMBAT_MAX_SHIPS], retreat[COMBAT_MAX_SHIPS];
+
+	for (int i = 0; i < initial.count; i++) {
+		if (initial.owner[i] == instance->player_id || initial.docked[i]) continue;
+
+		const Vector2 location = { initial.x[i], initial.y[i] };
+		Vector2 closest = location;
+		double closestDistance = INF;
+		for (int j = 0; j < initial.count; j++) {
+			if (initial.owner[j] != instance->player_id) continue;
+			const Vector2 other = { initial.x[j], initial.y[j] };
+			if (location.DistanceTo(other) < closestDistance) {
+				closestDistance = location.DistanceTo(other);
+				closest = other;
+			}
+		}
+		if (closestDistance == INF) continue;
+
+		const double angle = location.OrientTowardsRad(closest);
+		charge[enemies_count] = Vector2::Velocity(angle, std::min(hlt::constants::MAX_SPEED, (int)closestDistance));
+		retreat[enemies_count] = Vector2::Velocity(angle + M_PI, hlt::constants::MAX_SPEED);
+		enemies[enemies_count++] = i;
+	}
+
+	bool searchable = false;
+	for (int d = 0; d < decisions_count; d++)
+		searchable |= !decisions[d].fixed;
+	if (!searchable || enemies_count == 0)
+		return 0;
+
+	// 0: everyone charges, 1: everyone stays, the rest are random
+	Vector2 responses[SKIRMISH_SCENARIOS][COMBAT_MAX_SHIPS];
+	std::mt19937 rng(instance->turn * 7919 + decisions[0].navReq->ship->entity_id);
+	for (int s = 0; s < SKIRMISH_SCENARIOS; s++) {
+		for (int e = 0; e < enemies_count; e++) {
+			int response = s < 2 ? s : (int)(rng() % 3);
+			responses[s][e] = response == 0 ? charge[e] : (response == 1 ? Vector2{ 0, 0 } : retreat[e]);
+		}
+	}
+
+	auto evaluate = [&]() {
+		double total = 0;
+		for (int s = 0; s < SKIRMISH_SCENARIOS; s++) {
+			Combat combat = initial;
+			for (int e = 0; e < enemies_count; e++)
+				combat.SetVelocity(enemies[e], responses[s][e]);
+			for (int d = 0; d < decisions_count; d++) {
+				const SkirmishMove& move = decisions[d].candidates[decisions[d].current];
+				combat.SetVelocity(decisions[d].index, instance->velocityCache[move.angle][move.thrust]);
+			}
+			combat.Step();
+			total += combat.Evaluate(instance->player_id);
+		}
+
+		double distances = 0;
+		for (int d = 0; d < decisions_count; d++) {
+			const SkirmishMove& move = decisions[d].candidates[decisions[d].current];
+			const NavigationRequest* navReq = decisions[d].navReq;
+			distances += (navReq->ship->location + instance->velocityCache[move.angle][move.thrust]).DistanceTo(navReq->targetLocation);
+		}
+
+		return total / SKIRMISH_SCENARIOS - distances * SKIRMISH_DISTANCE_WEIGHT;
+	};
+
+	const double heuristicScore = evaluate();
+	double bestScore = heuristicScore;
+
+	// best response of every ship to the rest, until nothing improves
+	bool timeout = false;
+	for (int pass = 0; pass < SKIRMISH_MAX_PASSES && !timeout; pass++) {
+		bool improved = false;
+
+		for (int d = 0; d < decisions_count && !timeout; d++) {
+			SkirmishDecision& decision = decisions[d];
+			const int previous = decision.current;
+
+			for (int c = 0; c < decision.candidates_count; c++) {
+				if (c == previous) continue;
+				if (instance->CurrentTurnTime() > time_limit) {
+					timeout = true;
+					break;
+				}
+
+				int best = decision.current;
+				decision.current = c;
+				double score = evaluate();
+				if (score > bestScore + 1e-9) {
+					bestScore = score;
+					improved = true;
+				}
+				else {
+					decision.current = best;
+				}
+			}
+		}
+
+		if (!improved)
+			break;
+	}
+
+	if (bestScore <= heuristicScore + 1e-9)
+		return 0;
+
+	// the joint move becomes the preferred option of every request
+	int changed = 0;
+	for (int d = 0; d < decisions_count; d++) {
+		SkirmishDecision& decision = decisions[d];
+		if (decision.fixed) continue;
+
+		const SkirmishMove& move = decision.candidates[decision.current];
+		Ship* ship = decision.navReq->ship;
+
+		decision.navReq->preferred_angle = move.angle;
+		decision.navReq->preferred_thrust = move.thrust;
+		// the candidates are valid moves, like CalculateScores does with the preferred option
+		for (NavigationOption& option : ship->navigationOptions) {
+			if (option.angle == move.angle && option.thrust == move.thrust)
+				option.score = PREFERRED_OPTION_SCORE;
+		}
+		std::sort(ship->navigationOptions.begin(), ship->navigationOptions.end());
+		ship->optionSelected = 0;
+
+		if (decision.current != 0)
+			changed++;
+	}
+
+	return changed;
+}
+
+void Skirmish::SearchAll(Instance* instance, const ArenaVector<ArenaVector<NavigationRequest*>>& components)
+{
+	// the components with some request near combat
+	ArenaVector<int> skirmishes(&instance->arena);
+	for (int c = 0; c < components.size(); c++) {
+		for (NavigationRequest* navReq : components[c]) {
+			if (navReq->near_combat) {
+				skirmishes.push_back(c);
+				break;
+			}
+		}
+	}
+	if (skirmishes.empty())
+		return;
+
+	const long long time_limit = std::min((long long)MAX_TIME, instance->CurrentTurnTime() + SKIRMISH_TIME);
+	int threads = std::max(1, std::min((int)std::thread::hardware_concurrency(), (int)skirmishes.size()));
+	Stopwatch s(instance, "Skirmish search (" + std::to_string(skirmishes.size()) + " skirmishes, " + std::to_string(threads) + " threads)");
+
+	std::atomic<int> next_skirmish(0);
+	std::atomic<int> changed(0);
+
+	auto worker = [&]() {
+		int i;
+		while ((i = next_skirmish++) < skirmishes.size())
+			changed += Search(instance, components[skirmishes[i]], time_limit);
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threads; i++)
+		workers.emplace_back(worker);
+	worker();
+	for (std::thread& t : workers)
+		t.join();
+
+	instance->logger.log() << "Skirmish search: " << skirmishes.size() << " skirmishes, " << changed << " ships with a better move" << std::endl;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Navigation.hpp"
+#include "Combat.hpp"
+
+// ms, the time for all the skirmish searches of a turn
+const int SKIRMISH_TIME = 200;
+
+/*
+	Searches the joint move of our ships in every skirmish with Combat.
+	A skirmish is a component of navigation requests (they can't interact with the rest,
+	see NavigateShips) with at least one request near combat.
+
+	Only the ships that don't avoid enemies (ATTACK, DEFEND...) are searched, the rest keep
+	the heuristic move. The search starts from the options that the heuristic scores prefer
+	and improves one ship at a time (the best response to the rest), evaluating every joint
+	move against a few sampled responses of the enemies (stay, charge, retreat) plus the
+	distance to the targets.
+	If the result is better than the heuristic joint move, it becomes the preferred
+	option of the requests (see CalculateScores), PickOptions still solves the conflicts.
+*/
+class Skirmish {
+public:
+	// searches the components on a pool of threads
+	static void SearchAll(Instance* instance, const ArenaVector<ArenaVector<NavigationRequest*>>& components);
+
+private:
+	// returns how many requests got a preferred option different from the heuristic one
+	static int Search(Instance* instance, const ArenaVector<NavigationRequest*>& component, long long time_limit);
+
+	Skirmish();
+};
@@ -0,0 +1,22 @@
+#include "Tables.hpp"
+
+#include <cmath>
+
+constexpr TrigTable Tables::trig;
+constexpr VelocityTable Tables::velocities;
+constexpr ThrustTable Tables::thrusts;
+
+int Tables::CountDifferences(int ulps)
+{
+	int count = 0;
+	for (int angle = 0; angle < 360; angle++) {
+		const double x = (angle * M_PI) / 180.0;
+		const double values[2][2] = { { trig.sin[angle], std::sin(x) }, { trig.cos[angle], std::cos(x) } };
+		for (const auto& value : values) {
+			const double ulp = std::nextafter(std::abs(value[1]), INFINITY) - std::abs(value[1]);
+			if (std::abs(value[0] - value[1]) > ulps * ulp)
+				count++;
+		}
+	}
+	return count;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "constants.hpp"
+#include "Vector2.hpp"
+
+// the thrusts of the velocity table, like the old Instance::velocityCache (up to MAX_SPEED * 2 - 1)
+const int TABLE_THRUSTS = hlt::constants::MAX_SPEED * 2;
+
+// double-double arithmetic (the value is hi + lo), so the tables don't depend on the size of long double
+// (it's a double with MSVC)
+struct DoubleDouble {
+	double hi, lo;
+};
+
+constexpr DoubleDouble QuickTwoSum(double a, double b)
+{
+	const double s = a + b;
+	return { s, b - (s - a) };
+}
+
+constexpr DoubleDouble TwoSum(double a, double b)
+{
+	const double s = a + b, bb = s - a;
+	return { s, (a - (s - bb)) + (b - bb) };
+}
+
+// a * b exactly (Dekker, the halves of the operands multiply without rounding)
+constexpr DoubleDouble TwoProd(double a, double b)
+{
+	const double split = 134217729.0; // 2^27 + 1
+	const double ca = split * a, ah = ca - (ca - a), al = a - ah;
+	const double cb = split * b, bh = cb - (cb - b), bl = b - bh;
+	const double p = a * b;
+	return { p, ((ah * bh - p) + ah * bl + al * bh) + al * bl };
+}
+
+constexpr DoubleDouble Add(DoubleDouble a, DoubleDouble b)
+{
+	const DoubleDouble s = TwoSum(a.hi, b.hi);
+	return QuickTwoSum(s.hi, s.lo + a.lo + b.lo);
+}
+
+constexpr DoubleDouble Mul(DoubleDouble a, DoubleDouble b)
+{
+	const DoubleDouble p = TwoProd(a.hi, b.hi);
+	return QuickTwoSum(p.hi, p.lo + a.hi * b.lo + a.lo * b.hi);
+}
+
+constexpr DoubleDouble Div(DoubleDouble a, double b)
+{
+	const double q1 = a.hi / b;
+	const DoubleDouble p = TwoProd(q1, b);
+	const DoubleDouble r = TwoSum(a.hi, -p.hi);
+	return QuickTwoSum(q1, (r.hi + (r.lo - p.lo + a.lo)) / b);
+}
+
+constexpr DoubleDouble ConstSeries(DoubleDouble r, DoubleDouble term, int first)
+{
+	const DoubleDouble r2 = Mul(r, r);
+	DoubleDouble sum = { 0, 0 };
+	for (int n = first; n < 30; n += 2) {
+		sum = Add(sum, term);
+		term = Div(Mul(term, { -r2.hi, -r2.lo }), (n + 1) * (n + 2));
+	}
+	return sum;
+}
+
+// sin and cos of (angle_deg * M_PI) / 180.0 evaluated by the compiler: the angle is reduced to
+// [-pi/4, pi/4] with the pi/2 of fdlibm split in 3 parts and the series are summed in double-double
+// (checked with g++, also with -mlong-double-64: only sin(297) differs from glibc, by one ulp, and the
+// table has the correctly rounded one; the local builds log the differences at startup)
+constexpr double ConstTrig(int angle_deg, bool cosine)
+{
+	const double x = (angle_deg * M_PI) / 180.0;
+
+	const double pio2_1 = 1.57079632673412561417e+00; // first 33 bits of pi/2
+	const double pio2_2 = 6.07710050630396597660e-11; // next 33 bits
+	const double pio2_2t = 2.02226624879595063154e-21; // pi/2 - (pio2_1 + pio2_2)
+
+	// k * pio2_1 and k * pio2_2 are exact and so is the first subtraction
+	const int k = (int)(x / 1.5707963267948966 + 0.5);
+	const DoubleDouble r = Add(TwoSum(x - k * pio2_1, -k * pio2_2), { -k * pio2_2t, 0 });
+	const double sin_r = ConstSeries(r, r, 1).hi, cos_r = ConstSeries(r, { 1, 0 }, 0).hi;
+
+	switch ((k + (cosine ? 1 : 0)) % 4) {
+	case 0: return sin_r;
+	case 1: return cos_r;
+	case 2: return -sin_r;
+	default: return -cos_r;
+	}
+}
+
+// the closest double to sqrt(value): Newton and one step in double-double
+constexpr double ConstSqrt(double value)
+{
+	if (value <= 0)
+		return 0;
+	double y = value > 1 ? value : 1;
+	for (int i = 0; i < 64; i++)
+		y = (y + value / y) / 2;
+	const DoubleDouble square = TwoProd(y, y);
+	return QuickTwoSum(y, ((value - square.hi) - square.lo) / (2 * y)).hi;
+}
+
+struct TrigTable {
+	double sin[360];
+	double cos[360];
+
+	constexpr TrigTable() : sin{}, cos{} {
+		for (int angle = 0; angle < 360; angle++) {
+			sin[angle] = ConstTrig(angle, false);
+			cos[angle] = ConstTrig(angle, true);
+		}
+	}
+};
+
+struct VelocityTable {
+	Vector2 velocity[360][TABLE_THRUSTS];
+
+	// like Vector2::Velocity
+	constexpr VelocityTable(const TrigTable& trig) : velocity{} {
+		for (int angle = 0; angle < 360; angle++) {
+			for (int thrust = 0; thrust < TABLE_THRUSTS; thrust++) {
+				velocity[angle][thrust].x = trig.cos[angle] * (double)thrust;
+				velocity[angle][thrust].y = trig.sin[angle] * (double)thrust;
+			}
+		}
+	}
+};
+
+struct ThrustTable {
+	// sqrt(2 * (thrust * thrust)), how far a thrust reaches along the diagonals of the map
+	double diagonal[hlt::constants::MAX_SPEED + 1];
+
+	constexpr ThrustTable() : diagonal{} {
+		for (int thrust = 0; thrust <= hlt::constants::MAX_SPEED; thrust++)
+			diagonal[thrust] = ConstSqrt(2 * (thrust * thrust));
+	}
+};
+
+/*
+	Tables built by the compiler (C++14 constexpr), so nothing is computed at runtime.
+	They are defined once in Tables.cpp.
+*/
+class Tables {
+public:
+	static constexpr TrigTable trig = TrigTable();
+	static constexpr VelocityTable velocities = VelocityTable(trig);
+	static constexpr ThrustTable thrusts = ThrustTable();
+
+	// sin and cos of the trig table further than ulps units in the last place from std::sin and std::cos
+	static int CountDifferences(int ulps);
+};
@@ -1,9 +1,12 @@
 #include "Task.hpp"
 
 #include <sstream>
+#include <algorithm>
 
-Task::Task(unsigned int task_id)
-	: task_id(task_id)
+#include "Instance.hpp"
+
+Task::Task(unsigned int task_id, TaskType type, EntityId key)
+	: task_id(task_id), type(type), key(key)
 {
 }
 
@@ -11,6 +14,23 @@ bool Task::IsFull() {
 	return max_ships != -1 && ships.size() >= max_ships;
 }
 
+void Task::AddShip(Ship* ship) {
+	ships.push_back(ship);
+
+	// the docking ships are not counted as friends
+	if (type == DOCK)
+		ship->instance->friendsDensity.Remove(ship);
+}
+
+void Task::RemoveShip(Ship* ship) {
+	auto it = std::find(ships.begin(), ships.end(), ship);
+	if (it != ships.end())
+		ships.erase(it);
+
+	if (type == DOCK && ship->IsOur() && ship->IsCommandable())
+		ship->instance->friendsDensity.Add(ship);
+}
+
 std::string Task::Info() {
 	std::stringstream ss;
 	ss << "type: ";
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <string>
-#include <set>
+#include <vector>
 
 #include "Ship.hpp"
 #include "Vector2.hpp"
@@ -24,18 +24,22 @@ enum TaskType {
 
 class Task {
 public:
-	Task(unsigned int task_id);
+	Task(unsigned int task_id, TaskType type, EntityId key);
 
 	bool IsFull();
+	void AddShip(Ship* ship);
+	void RemoveShip(Ship* ship);
 
 	std::string Info();
 
 	unsigned int task_id;
-	std::set<Ship*> ships; // ships assigned to this task
+	std::vector<Ship*> ships; // ships assigned to this task (rebuilt every turn)
 	int max_ships = -1; // -1 = infinite
 
 	/* Specific task related */
 	TaskType type = TaskType::NOTHING;
+	EntityId key; // what identifies the task in the registry (planet, enemy ship, index...)
+	unsigned int last_update = 0; // task generation
 	EntityId target = -1;
 	Vector2 location;
 	double radius = 0;
@@ -1,5 +1,13 @@
 #include "Vector2.hpp"
 
+#include "Tables.hpp"
+
+Vector2 Vector2::Velocity(double angle_rad, const int thrust)
+{
+	const int angle_deg = radToDegClipped(angle_rad);
+	return { Tables::trig.cos[angle_deg] * (double)thrust, Tables::trig.sin[angle_deg] * (double)thrust };
+}
+
 std::ostream& operator<<(std::ostream& out, const Vector2& location)
 {
 	out << '(' << location.x << ", " << location.y << ')';
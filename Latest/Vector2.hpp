@@ -27,12 +27,14 @@ public:
 
 	Vector2 ClosestPointTo(const Vector2& target, const double target_radius, const double min_dist = hlt::constants::MIN_DISTANCE_FOR_CLOSEST_POINT) {
 		const double radius = target_radius + min_dist;
-		const double angle_rad = target.OrientTowardsRad(*this);
 
-		const double x = target.x + radius * std::cos(angle_rad);
-		const double y = target.y + radius * std::sin(angle_rad);
+		// along the normalized direction from the target (the angle 0 if we are on it, like atan2)
+		const double dx = x - target.x, dy = y - target.y;
+		const double length = sqrt(dx * dx + dy * dy);
+		if (length == 0)
+			return { target.x + radius, target.y };
 
-		return { x, y };
+		return { target.x + radius * dx / length, target.y + radius * dy / length };
 	}
 
 	double OrientTowardsRad(const Vector2& target) const {
@@ -42,14 +44,8 @@ public:
 		return atan2(dy, dx) + 2 * M_PI;
 	}
 
-	static Vector2 Velocity(double angle_rad, const int thrust) {
-		int angle_deg = radToDegClipped(angle_rad);
-		angle_rad = (angle_deg * M_PI) / 180.0; // clamped angle
-
-		const double vel_x = cos(angle_rad) * (double)thrust;
-		const double vel_y = sin(angle_rad) * (double)thrust;
-		return { vel_x, vel_y };
-	}
+	// the angle is clamped to degrees, the trigonometry comes from Tables
+	static Vector2 Velocity(double angle_rad, const int thrust);
 
 	friend std::ostream& operator<<(std::ostream& out, const Vector2& location);
 };
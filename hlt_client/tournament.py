@@ -0,0 +1,398 @@
+"""
+Tournament between any set of bots (the versions/ archive, Latest, python bots...)
+using all the cores, on Linux.
+
+    python3 hlt_client/tournament.py Latest v41 v40 v35 -g 400 -j 8
+
+A bot is a directory name in versions/ (or Latest, or a path to a directory):
+the C++ bots are compiled with g++ once and cached in build/tournament/, the
+python bots are run with python3. "starter" is the in-process bot of SelfPlay.
+
+The games are played with SelfPlay (the native simulator of Latest/) or with the
+real engine (--halite path/to/halite), in 2 and 4 player formats on the small
+and big maps, always picking the bots with less games so far and shuffling
+the seats. The results are streamed into ratings (Bradley-Terry on the Elo
+scale, every game counts as the pairwise results between its players) with
+bootstrap confidence intervals, and timing stats for every bot.
+"""
+import argparse
+import collections
+import concurrent.futures
+import glob
+import math
+import os
+import random
+import re
+import subprocess
+import sys
+import threading
+import time
+
+_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+_BUILD_DIRECTORY = os.path.join(_ROOT, "build", "tournament")
+_STARTER = "starter"
+
+_MAP_SIZES = [(240, 160), (384, 256)]
+_FORMATS = [2, 4]
+
+# the tools of Latest, not part of the bot
+_EXCLUDED_SOURCES = ["Replay.cpp", "Benchmark.cpp", "SelfPlay.cpp", "Simulator.cpp"]
+# the old versions were built with msvc, that includes these everywhere
+_FORCED_INCLUDES = ["limits", "cmath", "algorithm", "functional", "cstring"]
+
+_ENGINE_RANK_REGEX = re.compile(r"Player #(\d+), (.*?), came in rank #(\d+)")
+
+_ELO_SCALE = 400 / math.log(10)
+# virtual draws against an average bot, so a bot that won every game doesn't go to infinity
+_PRIOR_GAMES = 1.0
+
+
+def _bot_directory(name):
+    """
+    :param name: A bot name (versions/<name>, Latest or a directory)
+    :return: The directory of the bot
+    """
+    for directory in [os.path.join(_ROOT, "versions", name), os.path.join(_ROOT, name), name]:
+        if os.path.isdir(directory):
+            return os.path.abspath(directory)
+    raise ValueError("Can't find the bot {}".format(name))
+
+
+def _compile(output, sources, include_directory, defines=()):
+    """
+    Compiles the sources with g++ unless the binary is newer than all of them.
+    :return: The binary
+    """
+    if os.path.exists(output) and all(os.path.getmtime(output) > os.path.getmtime(source) for source in sources):
+        return output
+
+    command = ["g++", "-std=c++14", "-O2", "-pthread", "-w", "-D_USE_MATH_DEFINES", "-I", include_directory]
+    for include in _FORCED_INCLUDES:
+        command += ["-include", include]
+    for define in defines:
+        command += ["-D" + define]
+    command += sources + ["-o", output]
+
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    if result.returncode != 0:
+        raise RuntimeError("Can't compile {}:\n{}".format(output, result.stdout.decode(errors="replace")[-3000:]))
+    return output
+
+
+def build_bot(name):
+    """
+    :param name: A bot name
+    :return: The command to run the bot
+    """
+    if name == _STARTER:
+        return _STARTER
+
+    directory = _bot_directory(name)
+
+    if os.path.exists(os.path.join(directory, "MyBot.py")):
+        # the python bots load their files relative to the working directory
+        return "sh -c 'cd \"{}\" && exec python3 MyBot.py'".format(directory)
+
+    sources = glob.glob(os.path.join(directory, "*.cpp")) + glob.glob(os.path.join(directory, "hlt", "*.cpp"))
+    sources = sorted(source for source in sources if os.path.basename(source) not in _EXCLUDED_SOURCES)
+    if not sources:
+        raise ValueError("{} has no MyBot.py or .cpp files".format(directory))
+
+    binary = os.path.join(_BUILD_DIRECTORY, os.path.basename(directory))
+    return "'{}'".format(_compile(binary, sources, directory))
+
+
+def build_selfplay():
+    """
+    :return: The SelfPlay binary (built from Latest/)
+    """
+    directory = os.path.join(_ROOT, "Latest")
+    sources = [os.path.join(directory, source) for source in ["Vector2.cpp", "Tables.cpp", "Simulator.cpp", "SelfPlay.cpp"]]
+    return _compile(os.path.join(_BUILD_DIRECTORY, "SelfPlay"), sources, directory)
+
+
+class GameResult:
+    def __init__(self, bots, ranks, map_size, turns, seconds, timings):
+        """
+        :param bots: The names of the bots, by seat
+        :param ranks: The rank of every bot (0 = first)
+        :param timings: (avg ms, max ms, failed) of every bot, or None if unknown
+        """
+        self.bots = bots
+        self.ranks = ranks
+        self.map_size = map_size
+        self.turns = turns
+        self.seconds = seconds
+        self.timings = timings
+
+
+def _play_selfplay(selfplay, commands, bots, map_size, seed):
+    """
+    Plays a game with SelfPlay.
+    :return: The GameResult
+    """
+    command = [selfplay, "-q", "-g", "1", "-j", "1", "-W", str(map_size[0]), "-H", str(map_size[1]), "-s", str(seed)]
+    # the bots write their logs in the working directory
+    output = subprocess.run(command + commands, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                            cwd=_BUILD_DIRECTORY).stdout.decode()
+
+    line = next((line for line in output.splitlines() if line.startswith("result ")), None)
+    if line is None:
+        raise RuntimeError("SelfPlay failed: {}".format(output))
+
+    # result width height seed turns seconds [rank avg_ms max_ms failed]...
+    fields = line.split()
+    per_bot = fields[6:]
+    ranks = [int(per_bot[4 * i]) for i in range(len(bots))]
+    timings = [(float(per_bot[4 * i + 1]), float(per_bot[4 * i + 2]), per_bot[4 * i + 3] == "1") for i in range(len(bots))]
+    return GameResult(bots, ranks, map_size, int(fields[4]), float(fields[5]), timings)
+
+
+def _play_halite(halite, commands, bots, map_size, seed, directory):
+    """
+    Plays a game with the engine, like compare_bots.py.
+    :return: The GameResult
+    """
+    command = [halite, "-q", "-t", "-d", "{} {}".format(*map_size), "-s", str(seed)]
+    start = time.time()
+    output = subprocess.run(command + commands, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, cwd=directory).stdout.decode()
+
+    ranks = [None] * len(bots)
+    for match in _ENGINE_RANK_REGEX.finditer(output):
+        ranks[int(match.group(1))] = int(match.group(3)) - 1
+    if None in ranks:
+        raise RuntimeError("The engine failed: {}".format(output[-1000:]))
+    return GameResult(bots, ranks, map_size, 0, time.time() - start, None)
+
+
+class Ratings:
+    """
+    Bradley-Terry ratings on the Elo scale: a game with n players counts as the
+    n * (n - 1) / 2 pairwise results between them.
+    """
+
+    def __init__(self, bots):
+        self.bots = bots
+        self.pairs = []  # (winner, loser)
+
+    def add(self, result):
+        for i in range(len(result.bots)):
+            for j in range(len(result.bots)):
+                if result.ranks[i] < result.ranks[j]:
+                    self.pairs.append((result.bots[i], result.bots[j]))
+
+    def _fit(self, pairs, iterations=200):
+        """
+        Minorization-maximization (Hunter 2004).
+        :return: bot -> rating, the average is 0
+        """
+        index = {bot: i for i, bot in enumerate(self.bots)}
+        n = len(self.bots)
+        wins = [_PRIOR_GAMES / 2] * n
+        games = collections.Counter()
+        for winner, loser in pairs:
+            wins[index[winner]] += 1
+            games[(min(index[winner], index[loser]), max(index[winner], index[loser]))] += 1
+
+        opponents = [[] for _ in range(n)]
+        for (i, j), count in games.items():
+            opponents[i].append((j, count))
+            opponents[j].append((i, count))
+
+        strength = [1.0] * n
+        for _ in range(iterations):
+            new_strength = []
+            for i in range(n):
+                # the prior is a game against a bot of strength 1
+                denominator = _PRIOR_GAMES / (strength[i] + 1)
+                for j, count in opponents[i]:
+                    denominator += count / (strength[i] + strength[j])
+                new_strength.append(wins[i] / denominator)
+            mean = sum(math.log(s) for s in new_strength) / n
+            strength = [s / math.exp(mean) for s in new_strength]
+
+        return {bot: _ELO_SCALE * math.log(strength[index[bot]]) for bot in self.bots}
+
+    def compute(self, samples=100):
+        """
+        :return: bot -> (rating, low, high) with a 95% bootstrap interval
+        """
+        ratings = self._fit(self.pairs)
+        if not self.pairs:
+            return {bot: (0, 0, 0) for bot in self.bots}
+
+        resampled = collections.defaultdict(list)
+        for _ in range(samples):
+            sample = [random.choice(self.pairs) for _ in self.pairs]
+            for bot, rating in self._fit(sample, iterations=50).items():
+                resampled[bot].append(rating)
+
+        intervals = {}
+        for bot in self.bots:
+            values = sorted(resampled[bot])
+            intervals[bot] = (ratings[bot], values[int(0.025 * (samples - 1))], values[int(0.975 * (samples - 1))])
+        return intervals
+
+
+class Stats:
+    def __init__(self):
+        self.games = 0
+        self.rank_counts = collections.Counter()  # (players, rank) -> games
+        self.total_ms = 0
+        self.timed_games = 0
+        self.max_ms = 0
+        self.failures = 0
+
+
+class Tournament:
+    def __init__(self, bots, commands, play, formats, map_sizes, seed):
+        """
+        :param bots: The names of the bots
+        :param commands: bot -> command
+        :param play: function (commands, bots, map size, seed) -> GameResult
+        """
+        self.bots = bots
+        self.commands = commands
+        self.play = play
+        self.formats = [players for players in formats if players <= len(bots)]
+        self.map_sizes = map_sizes
+        self.random = random.Random(seed)
+        self.lock = threading.Lock()
+
+        self.ratings = Ratings(bots)
+        self.stats = {bot: Stats() for bot in bots}
+        self.scheduled = collections.Counter()
+        self.games_played = 0
+        self.errors = 0
+
+    def next_game(self, index):
+        """
+        Picks the bots with less games so far, alternating formats and map sizes.
+        :return: (bots by seat, map size, seed)
+        """
+        with self.lock:
+            players = self.formats[index % len(self.formats)]
+            map_size = self.map_sizes[(index // len(self.formats)) % len(self.map_sizes)]
+
+            candidates = list(self.bots)
+            self.random.shuffle(candidates)
+            candidates.sort(key=lambda bot: self.scheduled[bot])
+            bots = candidates[:players]
+            self.random.shuffle(bots)
+            for bot in bots:
+                self.scheduled[bot] += 1
+
+            return bots, map_size, self.random.randrange(1 << 30)
+
+    def run_game(self, index):
+        bots, map_size, seed = self.next_game(index)
+        try:
+            result = self.play([self.commands[bot] for bot in bots], bots, map_size, seed)
+        except RuntimeError as error:
+            with self.lock:
+                self.errors += 1
+            print(error, file=sys.stderr)
+            return
+
+        with self.lock:
+            self.games_played += 1
+            self.ratings.add(result)
+            for i, bot in enumerate(bots):
+                stats = self.stats[bot]
+                stats.games += 1
+                stats.rank_counts[(len(bots), result.ranks[i])] += 1
+                if result.timings is not None:
+                    average_ms, max_ms, failed = result.timings[i]
+                    stats.total_ms += average_ms
+                    stats.timed_games += 1
+                    stats.max_ms = max(stats.max_ms, max_ms)
+                    stats.failures += failed
+
+            ordered = sorted(range(len(bots)), key=lambda i: result.ranks[i])
+            print("Game {:4d} {}x{} {:4d} turns {:6.1f}s: {}".format(
+                self.games_played, result.map_size[0], result.map_size[1], result.turns, result.seconds,
+                " > ".join(bots[i] for i in ordered)))
+
+    def report(self):
+        with self.lock:
+            ratings = self.ratings.compute()
+            stats = {bot: self.stats[bot] for bot in self.bots}
+            games = self.games_played
+
+        print()
+        print("After {} games ({} errors)".format(games, self.errors))
+        print("{:<20} {:>6} {:>15} {:>6} {:>7} {:>7} {:>9} {:>9} {:>6}".format(
+            "bot", "elo", "95%", "games", "2p win", "4p win", "avg ms", "max ms", "fails"))
+        for bot in sorted(self.bots, key=lambda bot: -ratings[bot][0]):
+            rating, low, high = ratings[bot]
+            s = stats[bot]
+
+            def win_rate(players):
+                total = sum(count for (p, _), count in s.rank_counts.items() if p == players)
+                return "{:6.1f}%".format(100 * s.rank_counts[(players, 0)] / total) if total else "      -"
+
+            print("{:<20} {:>6.0f} {:>15} {:>6d} {} {} {:>9} {:>9} {:>6d}".format(
+                bot, rating, "[{:.0f}, {:.0f}]".format(low, high), s.games, win_rate(2), win_rate(4),
+                "{:.1f}".format(s.total_ms / s.timed_games) if s.timed_games else "-",
+                "{:.1f}".format(s.max_ms) if s.timed_games else "-", s.failures))
+        print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Tournament between bots on all the cores.")
+    parser.add_argument("bots", nargs="+", help="Names in versions/, Latest, a directory or \"starter\"")
+    parser.add_argument("-g", "--games", type=int, default=200, help="Number of games")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="Games at the same time")
+    parser.add_argument("-f", "--formats", type=int, nargs="+", default=_FORMATS, choices=_FORMATS, help="Player counts")
+    parser.add_argument("--small", action="store_true", help="Only the small map")
+    parser.add_argument("--big", action="store_true", help="Only the big map")
+    parser.add_argument("--halite", help="Play with the engine binary instead of SelfPlay")
+    parser.add_argument("--report", type=int, default=50, help="Print the ratings every n games")
+    parser.add_argument("-s", "--seed", type=int, default=int(time.time()))
+    args = parser.parse_args()
+
+    if len(set(args.bots)) < 2:
+        parser.error("At least two different bots are needed")
+
+    map_sizes = _MAP_SIZES
+    if args.small and not args.big:
+        map_sizes = _MAP_SIZES[:1]
+    elif args.big and not args.small:
+        map_sizes = _MAP_SIZES[1:]
+
+    os.makedirs(_BUILD_DIRECTORY, exist_ok=True)
+    bots = list(collections.OrderedDict.fromkeys(args.bots))
+    commands = {}
+    for bot in bots:
+        print("Building {}".format(bot))
+        commands[bot] = build_bot(bot)
+
+    if args.halite:
+        if _STARTER in bots:
+            parser.error("The starter bot only exists in SelfPlay")
+        halite = os.path.abspath(args.halite)
+
+        def play(bot_commands, names, map_size, seed):
+            return _play_halite(halite, bot_commands, names, map_size, seed, _BUILD_DIRECTORY)
+    else:
+        selfplay = build_selfplay()
+
+        def play(bot_commands, names, map_size, seed):
+            return _play_selfplay(selfplay, bot_commands, names, map_size, seed)
+
+    tournament = Tournament(bots, commands, play, args.formats, map_sizes, args.seed)
+    start = time.time()
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=max(1, args.jobs)) as executor:
+        futures = [executor.submit(tournament.run_game, index) for index in range(args.games)]
+        for done, future in enumerate(concurrent.futures.as_completed(futures), 1):
+            future.result()
+            if done % args.report == 0 and done < args.games:
+                tournament.report()
+
+    tournament.report()
+    print("{:.0f} games/hour".format(tournament.games_played * 3600 / (time.time() - start)))
+
+
+if __name__ == "__main__":
+    main()
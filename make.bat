@@ -50,3 +50,11 @@ cl.exe /FeMyBot.exe /std:c++14 /O2 /MT /EHsc /I . /Fo.\obj\ ^
  .\Entity.cpp ^
  .\Ship.cpp ^
  .\Planet.cpp ^
+ .\Admission.cpp ^
+ .\Arena.cpp ^
+ .\Combat.cpp ^
+ .\Skirmish.cpp ^
+ .\Density.cpp ^
+ .\Routes.cpp ^
+ .\Fields.cpp ^
+ .\Tables.cpp ^